@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include "../../Algorithms/CH/CH.h"
+#include "../../Algorithms/CH/Query/BucketQuery.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Graph/Graph.h"
+
+#include "../../Helpers/Types.h"
+
+namespace Assignment {
+
+// Initial and final walking along shortest paths of the transfer graph, which are found with bucket queries on a
+// contraction hierarchy instead of scanning the edges between the zones and the stops. Thus, a transfer graph whose
+// closure has been limited (e.g. with the Max walking time of parseCSAFromCSV) still connects every zone to all stops
+// within maxWalkingTime. Walking between stops still uses the edges of the transfer graph. The stops are the POIs of
+// the bucket query, they have the vertex ids 0, ..., numberOfStops - 1.
+class AccessWalking {
+
+public:
+    using BucketQuery = CH::BucketQuery<>;
+
+    // Bucket query for one thread, the contraction hierarchy is shared.
+    class Query {
+
+    public:
+        Query(const AccessWalking& walking) :
+            walking(walking),
+            bucketQuery(walking.bucketQuery) {
+        }
+
+        // Calls function(stop, walkingTime) for every stop that can be reached from origin within the max walking time,
+        // including origin itself.
+        template<typename FUNCTION>
+        inline void forEachStopFrom(const Vertex origin, const FUNCTION& function) noexcept {
+            bucketQuery.template run<FORWARD, BACKWARD>(origin);
+            for (const Vertex stop : bucketQuery.getForwardPOIs()) {
+                const int walkingTime = bucketQuery.getForwardDistance(stop);
+                if (walkingTime > walking.maxWalkingTime) continue;
+                function(StopId(stop), walkingTime);
+            }
+        }
+
+        // Calls function(stop, walkingTime) for every stop from which target can be reached within the max walking time,
+        // including target itself.
+        template<typename FUNCTION>
+        inline void forEachStopTo(const Vertex target, const FUNCTION& function) noexcept {
+            bucketQuery.template run<BACKWARD, FORWARD>(target);
+            for (const Vertex stop : bucketQuery.getBackwardPOIs()) {
+                const int walkingTime = bucketQuery.getBackwardDistance(stop);
+                if (walkingTime > walking.maxWalkingTime) continue;
+                function(StopId(stop), walkingTime);
+            }
+        }
+
+        // Walking time between two vertices, INFTY if to cannot be reached.
+        inline int walkingTime(const Vertex from, const Vertex to) noexcept {
+            if (from == to) return 0;
+            bucketQuery.run(from, to);
+            return bucketQuery.reachable() ? bucketQuery.getDistance() : INFTY;
+        }
+
+    private:
+        const AccessWalking& walking;
+        BucketQuery bucketQuery;
+
+    };
+
+public:
+    AccessWalking(const CSA::Data& data, const int maxWalkingTime = -1) :
+        ch(BuildCH(data)),
+        bucketQuery(ch, FORWARD, data.numberOfStops()),
+        maxWalkingTime((maxWalkingTime < 0) ? INFTY : maxWalkingTime) {
+    }
+
+    AccessWalking(const AccessWalking&) = delete;
+    AccessWalking& operator=(const AccessWalking&) = delete;
+
+    inline int getMaxWalkingTime() const noexcept {
+        return maxWalkingTime;
+    }
+
+private:
+    inline static CH::CH BuildCH(const CSA::Data& data) noexcept {
+        using WitnessSearch = CH::WitnessSearch<CHCoreGraph, CH::NoProfiler, 500>;
+        CSA::TransferGraph graph = data.transferGraph.toStaticGraph();
+        CH::Builder<CH::NoProfiler, WitnessSearch, CH::GreedyKey<WitnessSearch>, CH::NoStopCriterion, false, false> builder(std::move(graph), TravelTime);
+        builder.run();
+        builder.copyCoreToCH();
+        return CH::CH(std::move(builder.getData()));
+    }
+
+private:
+    // The bucket query references the graphs of the contraction hierarchy.
+    const CH::CH ch;
+    const BucketQuery bucketQuery;
+    const int maxWalkingTime;
+
+};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+
+#include "../../DataStructures/Assignment/Settings.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Demand/AccumulatedVertexDemand.h"
+#include "../../DataStructures/Demand/SplitDemand.h"
+#include "../../DataStructures/Graph/Graph.h"
+
+#include "../../Helpers/Types.h"
+#include "../../Helpers/IO/Serialization.h"
+
+#include "PreparedNetwork.h"
+
+namespace Assignment {
+
+// Everything that is derived from the network and the demand before the first destination is assigned: the CSA data with
+// connections sorted by departure time, the reverse transfer graph, the prepared network, the original and the discretized
+// demand, and the discretized demand split by destination. The split depends on the demand settings of the assignment,
+// therefore a bundle can only be loaded with the same demand settings it was written with.
+class AssignmentBundle {
+
+private:
+    inline static constexpr size_t Version = 1;
+
+public:
+    using DemandByDestination = SplitDemand<AccumulatedVertexDemand::Entry>;
+
+    AssignmentBundle(const std::string& csaFileName, const std::string& demandFileName, const size_t demandMultiplier, const Settings& settings) :
+        data(SortedData(csaFileName)),
+        reverseGraph(ReverseGraph(data)),
+        preparedNetwork(data, reverseGraph),
+        originalDemand(AccumulatedVertexDemand::FromZoneCSV(demandFileName, data, reverseGraph, demandMultiplier)),
+        demand(DiscretizedDemand(originalDemand, settings)),
+        demandByDestination(Split(data, reverseGraph, demand, settings)),
+        demandMultiplier(demandMultiplier),
+        demandSettings(settings) {
+    }
+
+    // Loads a bundle written by serialize().
+    AssignmentBundle(const std::string& fileName, const Settings& settings) :
+        data(CSA::Data::FromBinary(getCSAFileName(fileName))),
+        reverseGraph(fileName + ".reverse"),
+        preparedNetwork(PreparedNetwork::FromBinary(fileName + ".network")),
+        originalDemand(AccumulatedVertexDemand::FromBinary(fileName + ".demand")),
+        demand(AccumulatedVertexDemand::FromBinary(fileName + ".discretized")),
+        demandByDestination(DemandByDestination::FromBinary(fileName + ".split")),
+        demandMultiplier(0) {
+        size_t version;
+        IO::deserialize(fileName + ".info", version, demandMultiplier, demandSettings.allowDepartureStops, demandSettings.mergeEquivalentDestinations, demandSettings.demandIntervalSplitTime, demandSettings.keepDemandIntervals, demandSettings.includeIntervalBorder);
+        Ensure(version == Version, "Bundle " << fileName << " has version " << version << ", but version " << Version << " is required!");
+        Ensure(settings.hasSameDemand(demandSettings), "Bundle " << fileName << " was prepared with different demand settings!");
+        Ensure(preparedNetwork.stationByStop.size() == data.numberOfStops(), "Bundle " << fileName << " is inconsistent!");
+    }
+
+    // The sorted CSA data is written to <fileName>.csa, which can be used wherever a CSA binary is expected.
+    inline static std::string getCSAFileName(const std::string& fileName) noexcept {
+        return fileName + ".csa";
+    }
+
+    inline void serialize(const std::string& fileName) const noexcept {
+        data.serialize(getCSAFileName(fileName));
+        reverseGraph.writeBinary(fileName + ".reverse");
+        preparedNetwork.serialize(fileName + ".network");
+        originalDemand.serialize(fileName + ".demand");
+        demand.serialize(fileName + ".discretized");
+        demandByDestination.serialize(fileName + ".split");
+        IO::serialize(fileName + ".info", Version, demandMultiplier, demandSettings.allowDepartureStops, demandSettings.mergeEquivalentDestinations, demandSettings.demandIntervalSplitTime, demandSettings.keepDemandIntervals, demandSettings.includeIntervalBorder);
+    }
+
+    // The steps of the preparation, for commands that need only some of them.
+    inline static CSA::Data SortedData(const std::string& csaFileName) noexcept {
+        CSA::Data result = CSA::Data::FromBinary(csaFileName);
+        result.sortConnectionsAscendingByDepartureTime();
+        return result;
+    }
+
+    inline static CSA::TransferGraph ReverseGraph(const CSA::Data& data) noexcept {
+        CSA::TransferGraph result = data.transferGraph.toStaticGraph();
+        result.revert();
+        return result;
+    }
+
+    inline static AccumulatedVertexDemand DiscretizedDemand(AccumulatedVertexDemand demand, const Settings& settings) noexcept {
+        if (settings.demandIntervalSplitTime >= 0) {
+            demand.discretize(settings.demandIntervalSplitTime, settings.keepDemandIntervals, settings.includeIntervalBorder);
+        }
+        return demand;
+    }
+
+    inline static DemandByDestination Split(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const AccumulatedVertexDemand& demand, const Settings& settings) noexcept {
+        DemandByDestination result(Construct::SplitByDestination, data, reverseGraph, demand.entries, settings.allowDepartureStops);
+        if (settings.mergeEquivalentDestinations) {
+            result.mergeEquivalentDestinations(data, reverseGraph);
+        }
+        return result;
+    }
+
+public:
+    CSA::Data data;
+    CSA::TransferGraph reverseGraph;
+    PreparedNetwork preparedNetwork;
+    AccumulatedVertexDemand originalDemand;
+    AccumulatedVertexDemand demand;
+    DemandByDestination demandByDestination;
+    size_t demandMultiplier;
+
+private:
+    // Only the demand settings are relevant
+    Settings demandSettings;
+
+};
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../../DataStructures/Assignment/AssignmentData.h"
+#include "../../DataStructures/Assignment/GroupData.h"
+#include "../../DataStructures/Assignment/Settings.h"
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/Demand/AccumulatedVertexDemand.h"
+
+#include "../../Helpers/Hash.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/FileSystem/FileSystem.h"
+#include "../../Helpers/IO/Serialization.h"
+#include "../../Helpers/String/String.h"
+
+namespace Assignment {
+
+// Stores the assignment result of every destination in <directory>/<destination>_<key>.assignment, where the key is a
+// hash of the network, the settings and the demand for the destination. A destination has to be recomputed only if no
+// result with a matching key exists. The key depends only on the content of the demand entries, and the stored groups
+// refer to their demand entry by its position within the demand of the destination, so inserting or removing demand
+// rows of other destinations does not invalidate a result.
+class AssignmentStore {
+
+private:
+    inline static constexpr size_t Version = 2;
+
+public:
+    AssignmentStore(const std::string& directory, const std::string& csaFileName, const Settings& settings, const bool useTransferBufferTimes) :
+        directory(directory) {
+        FileSystem::makeDirectory(directory);
+        Settings keySettings = settings;
+        keySettings.profilerType = 0;
+        keySettings.footpathRelaxation = PushFootpaths;
+        const std::string settingsFileName = FileSystem::extendPath(directory, "settings.conf");
+        const ConfigFile config = keySettings.toConfigFile(settingsFileName);
+        writeSettingsFile(config);
+        std::stringstream settingsString;
+        settingsString << Version << "," << useTransferBufferTimes << "\n" << config;
+        baseKey = Hash::string(settingsString.str(), Hash::csaBinary(csaFileName));
+        for (const std::string& fileName : FileSystem::getFiles(directory)) {
+            if (!String::endsWith(fileName, ".assignment")) continue;
+            const size_t separator = fileName.find('_');
+            if (separator >= fileName.size()) continue;
+            fileByDestination.insert(String::lexicalCast<size_t>(fileName.substr(0, separator)), fileName);
+        }
+    }
+
+    inline uint64_t getKey(const std::vector<AccumulatedVertexDemand::Entry>& demand) const noexcept {
+        uint64_t key = baseKey;
+        for (const AccumulatedVertexDemand::Entry& entry : demand) {
+            key = Hash::object(entry.earliestDepartureTime, key);
+            key = Hash::object(entry.latestDepartureTime, key);
+            key = Hash::object(entry.originVertex, key);
+            key = Hash::object(entry.destinationVertex, key);
+            key = Hash::object(entry.numberOfPassengers, key);
+        }
+        return key;
+    }
+
+    inline bool contains(const Vertex destination, const uint64_t key) const noexcept {
+        return FileSystem::isFile(getFileName(destination, key));
+    }
+
+    // Replaces the previous result for the destination, if there is one. The groups of assignmentData have to belong to
+    // the given demand of the destination.
+    inline void store(const Vertex destination, const uint64_t key, const std::vector<AccumulatedVertexDemand::Entry>& demand, const AssignmentData& assignmentData, const u_int64_t removedCycleConnections, const u_int64_t removedCycles) const noexcept {
+        Map<size_t, size_t> positionOfDemandIndex;
+        for (size_t i = demand.size(); i-- > 0;) {
+            positionOfDemandIndex.insert(demand[i].demandIndex, i);
+        }
+        std::vector<GroupData> groups;
+        groups.reserve(assignmentData.groups.size());
+        for (const GroupData& group : assignmentData.groups) {
+            AssertMsg(positionOfDemandIndex.contains(group.demandIndex), "Group " << group.groupId << " belongs to no demand of destination " << destination << "!");
+            groups.emplace_back(group.groupId, positionOfDemandIndex.at(group.demandIndex), group.groupSize);
+        }
+        write(destination, key, removedCycleConnections, removedCycles, groups, assignmentData);
+    }
+
+    // Appends the stored groups of the destination to assignmentData. The groups are not added to groupsPerConnection,
+    // this has to be done by calling assignmentData.addGroupsToConnections() after all destinations have been appended.
+    inline void appendTo(const Vertex destination, const uint64_t key, const std::vector<AccumulatedVertexDemand::Entry>& demand, AssignmentData& assignmentData, u_int64_t& removedCycleConnections, u_int64_t& removedCycles) const noexcept {
+        u_int64_t destinationRemovedCycleConnections;
+        u_int64_t destinationRemovedCycles;
+        std::vector<GroupData> groups;
+        std::vector<std::vector<ConnectionId>> connectionsPerGroup;
+        GroupList unassignedGroups;
+        GroupList directWalkingGroups;
+        IO::deserialize(getFileName(destination, key), destinationRemovedCycleConnections, destinationRemovedCycles, groups, connectionsPerGroup, unassignedGroups, directWalkingGroups);
+        removedCycleConnections += destinationRemovedCycleConnections;
+        removedCycles += destinationRemovedCycles;
+        const size_t groupOffset = assignmentData.groups.size();
+        for (const GroupData& group : groups) {
+            AssertMsg(group.demandIndex < demand.size(), "Stored group " << group.groupId << " of destination " << destination << " has no demand entry!");
+            assignmentData.groups.emplace_back(group.groupId + groupOffset, demand[group.demandIndex].demandIndex, group.groupSize);
+        }
+        for (std::vector<ConnectionId>& connections : connectionsPerGroup) {
+            assignmentData.connectionsPerGroup.emplace_back(std::move(connections));
+        }
+        for (const GroupId group : unassignedGroups) {
+            assignmentData.unassignedGroups.emplace_back(group + groupOffset);
+        }
+        for (const GroupId group : directWalkingGroups) {
+            assignmentData.directWalkingGroups.emplace_back(group + groupOffset);
+        }
+    }
+
+    // Copies the result of the destination from source (e.g. the store of a previous timetable version) into this store,
+    // with the connection ids translated by connectionMapping. Fails if the result uses a connection without counterpart.
+    inline bool migrateFrom(const AssignmentStore& source, const Vertex destination, const uint64_t sourceKey, const uint64_t key, const std::vector<ConnectionId>& connectionMapping) const noexcept {
+        if (!source.contains(destination, sourceKey)) return false;
+        u_int64_t removedCycleConnections;
+        u_int64_t removedCycles;
+        AssignmentData assignmentData(0);
+        IO::deserialize(source.getFileName(destination, sourceKey), removedCycleConnections, removedCycles, assignmentData.groups, assignmentData.connectionsPerGroup, assignmentData.unassignedGroups, assignmentData.directWalkingGroups);
+        for (std::vector<ConnectionId>& connections : assignmentData.connectionsPerGroup) {
+            for (ConnectionId& connection : connections) {
+                if (connection >= connectionMapping.size() || connectionMapping[connection] == noConnection) return false;
+                connection = connectionMapping[connection];
+            }
+        }
+        write(destination, key, removedCycleConnections, removedCycles, assignmentData.groups, assignmentData);
+        return true;
+    }
+
+private:
+    inline void write(const Vertex destination, const uint64_t key, const u_int64_t removedCycleConnections, const u_int64_t removedCycles, const std::vector<GroupData>& groups, const AssignmentData& assignmentData) const noexcept {
+        const std::string fileName = getFileName(destination, key);
+        if (fileByDestination.contains(destination.value())) {
+            const std::string oldFileName = FileSystem::extendPath(directory, fileByDestination.at(destination.value()));
+            if (oldFileName != fileName) FileSystem::deleteFile(oldFileName);
+        }
+        IO::serialize(fileName, removedCycleConnections, removedCycles, groups, assignmentData.connectionsPerGroup, assignmentData.unassignedGroups, assignmentData.directWalkingGroups);
+    }
+
+    // The settings file is only for inspection, it is rewritten only if it is missing or outdated. Since several runs may
+    // share the store, it is replaced atomically.
+    inline void writeSettingsFile(const ConfigFile& config) const noexcept {
+        std::stringstream newContent;
+        newContent << config;
+        std::ifstream oldFile(config.getFilename());
+        if (oldFile) {
+            std::stringstream oldContent;
+            oldContent << oldFile.rdbuf();
+            if (oldContent.str() == newContent.str()) return;
+        }
+        const std::string temporaryFileName = config.getFilename() + "." + std::to_string(getpid()) + ".tmp";
+        std::ofstream temporaryFile(temporaryFileName);
+        temporaryFile << newContent.str();
+        temporaryFile.close();
+        if (!temporaryFile || std::rename(temporaryFileName.c_str(), config.getFilename().c_str()) != 0) {
+            FileSystem::deleteFile(temporaryFileName);
+        }
+    }
+
+    inline std::string getFileName(const Vertex destination, const uint64_t key) const noexcept {
+        return FileSystem::extendPath(directory, std::to_string(destination.value()) + "_" + Hash::toString(key) + ".assignment");
+    }
+
+private:
+    const std::string directory;
+    uint64_t baseKey;
+    Map<size_t, std::string> fileByDestination;
+
+};
+
+}
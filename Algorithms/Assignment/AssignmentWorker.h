@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "../../DataStructures/Assignment/AssignmentData.h"
@@ -8,29 +9,37 @@
 #include "../../DataStructures/Assignment/GroupTrackingData.h"
 #include "../../DataStructures/Assignment/Settings.h"
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
 #include "../../DataStructures/Demand/AccumulatedVertexDemand.h"
 #include "../../DataStructures/Graph/Graph.h"
 
 #include "../../Helpers/Helpers.h"
+#include "../../Helpers/MultiThreading.h"
 #include "../../Helpers/Vector/Vector.h"
 
+#include "AccessWalking.h"
 #include "ComputePATs.h"
 #include "CycleRemoval.h"
+#include "DemandCompaction.h"
+#include "PATCache.h"
 #include "PassengerDistribution.h"
+#include "PreparedNetwork.h"
 #include "Profiler.h"
+#include "TripBasedPATs.h"
 
 namespace Assignment {
 
-template<typename DECISION_MODEL, typename PROFILER, bool USE_TRANSFER_BUFFER_TIMES = false>
+// PAT_COMPUTATION: ComputePATs or TripBasedPATs, which compute the same PATs.
+template<typename DECISION_MODEL, typename PROFILER, bool USE_TRANSFER_BUFFER_TIMES = false, typename PAT_COMPUTATION = ComputePATs<NoPATProfiler, USE_TRANSFER_BUFFER_TIMES>>
 class AssignmentWorker {
 
 public:
     using DecisionModel = DECISION_MODEL;
     using Profiler = PROFILER;
     constexpr static inline bool UseTransferBufferTimes = USE_TRANSFER_BUFFER_TIMES;
-    using Type = AssignmentWorker<DecisionModel, Profiler, UseTransferBufferTimes>;
+    using PATComputationType = PAT_COMPUTATION;
+    using Type = AssignmentWorker<DecisionModel, Profiler, UseTransferBufferTimes, PATComputationType>;
 
-    using PATComputationType = ComputePATs<NoPATProfiler, UseTransferBufferTimes>;
     using ConnectionLabel = typename PATComputationType::ConnectionLabel;
 
     struct ProfileReader {
@@ -64,40 +73,80 @@ public:
     };
 
 public:
-    AssignmentWorker(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Settings& settings, const DecisionModel& decisionModel) :
+    // numberOfPATBuffers: 1 for regular execution, 2 for pipelined execution, 0 if the PATs are always provided by the caller.
+    // periodicTimetable: the groups are assigned to the connections of the periodic timetable and the connections of the
+    // next day are replaced by the original ones after the cycle removal. PATs provided by the caller have to use it as well.
+    // accessWalking: the initial and final walking follows shortest paths of the transfer graph (see AccessWalking).
+    AssignmentWorker(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Settings& settings, const DecisionModel& decisionModel, const size_t numberOfPATBuffers = 1, const PATCache* patCache = nullptr, const PreparedNetwork* preparedNetwork = nullptr, const CSA::PeriodicTimetable* periodicTimetable = nullptr, const AccessWalking* accessWalking = nullptr) :
         data(data),
         reverseGraph(reverseGraph),
         settings(settings),
         decisionModel(decisionModel),
-        patComputation(data, reverseGraph),
+        patCache(patCache),
+        periodicTimetable(periodicTimetable),
+        accessWalking(accessWalking),
+        currentPATs(0),
+        activePATs(nullptr),
         profiles(data.numberOfStops()),
-        groupTrackingData(data.numberOfStops(), data.numberOfTrips()),
+        groupTrackingData(data.numberOfStops(), periodicTimetable ? periodicTimetable->numberOfTrips() : data.numberOfTrips()),
         assignmentData(data.numberOfConnections()),
-        cycleRemoval(data, settings.cycleMode, assignmentData) {
+        cycleRemoval(data, settings.cycleMode, assignmentData, preparedNetwork ? &preparedNetwork->stationByStop : nullptr, periodicTimetable),
+        demandCompaction(data, assignmentData) {
+        patComputations.reserve(numberOfPATBuffers);
+        for (size_t i = 0; i < numberOfPATBuffers; i++) {
+            patComputations.emplace_back(data, reverseGraph);
+            if (preparedNetwork) patComputations.back().setStopReverseGraph(&preparedNetwork->stopReverseGraph);
+            patComputations.back().setPullFootpaths(settings.footpathRelaxation == PullFootpaths);
+            if (periodicTimetable) patComputations.back().setPeriodicTimetable(periodicTimetable);
+            if (accessWalking) patComputations.back().setAccessWalking(accessWalking);
+        }
+        if (accessWalking) accessWalkingQuery = std::make_unique<AccessWalking::Query>(*accessWalking);
         profiler.initialize(data);
     }
 
     inline void run(const Vertex destinationVertex, std::vector<AccumulatedVertexDemand::Entry>& demand) noexcept {
-        AssertMsg(!demand.empty(), "Demand for destination vertex " << destinationVertex << " is empty!");
-        AssertMsg(data.isStop(destinationVertex) || reverseGraph.outDegree(destinationVertex) > 0, "Destination vertex " << destinationVertex << " is isolated!");
+        AssertMsg(!patComputations.empty(), "Worker has been constructed without PAT buffers!");
         profiler.startAssignmentForDestination(destinationVertex);
-
-        sort(demand, [](const AccumulatedVertexDemand::Entry& a, const AccumulatedVertexDemand::Entry& b){return a.earliestDepartureTime < b.earliestDepartureTime;});
-
         profiler.startPATComputation();
-        patComputation.run(destinationVertex, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+        if (computePATs(patComputation(), destinationVertex)) profiler.patCacheHit();
         profiler.donePATComputation();
+        assign(destinationVertex, demand, patComputation());
+        profiler.doneAssignmentForDestination(destinationVertex);
+    }
 
-        profiler.startInitialWalking();
-        initializeAssignment(demand);
-        profiler.doneInitialWalking();
-        profiler.startAssignment();
-        for (const ConnectionId i : data.connectionIds()) {
-            profiler.assignConnection(i);
-            processConnection(i);
-        }
-        profiler.doneAssignment();
+    // Assigns the demand using PATs for destinationVertex that have been computed by the caller, which allows several
+    // workers (e.g. with different decision models) to share one PAT computation.
+    inline void run(const Vertex destinationVertex, std::vector<AccumulatedVertexDemand::Entry>& demand, const PATComputationType& pats) noexcept {
+        profiler.startAssignmentForDestination(destinationVertex);
+        assign(destinationVertex, demand, pats);
+        profiler.doneAssignmentForDestination(destinationVertex);
+    }
 
+    // Two-stage pipeline: The PATs for destinationVertex have to be computed by a previous call of startPipeline() or runPipelined().
+    // While the groups for destinationVertex are assigned, a helper thread computes the PATs for nextDestinationVertex into the second buffer.
+    // The helper thread is started by the first call of startPipeline() and is kept for the lifetime of the worker.
+    inline void startPipeline(const Vertex destinationVertex, const int coreId = -1) noexcept {
+        AssertMsg(patComputations.size() == 2, "Worker has not been constructed for pipelined execution!");
+        if (!helper) helper = std::make_unique<HelperThread>(coreId);
+        if (computePATs(patComputation(), destinationVertex)) profiler.patCacheHit();
+    }
+
+    inline void runPipelined(const Vertex destinationVertex, std::vector<AccumulatedVertexDemand::Entry>& demand, const Vertex nextDestinationVertex) noexcept {
+        AssertMsg(patComputations.size() == 2, "Worker has not been constructed for pipelined execution!");
+        AssertMsg(helper, "The pipeline has not been started!");
+        profiler.startAssignmentForDestination(destinationVertex);
+        bool nextPATsFromCache = false;
+        if (nextDestinationVertex != noVertex) {
+            helper->run([&]() {
+                nextPATsFromCache = computePATs(patComputations[1 - currentPATs], nextDestinationVertex);
+            });
+        }
+        assign(destinationVertex, demand, patComputation());
+        profiler.startPATComputation();
+        helper->wait();
+        profiler.donePATComputation();
+        if (nextPATsFromCache) profiler.patCacheHit();
+        currentPATs = 1 - currentPATs;
         profiler.doneAssignmentForDestination(destinationVertex);
     }
 
@@ -123,11 +172,88 @@ public:
         return profiler;
     }
 
+    // Results become independent of the order in which the destinations are processed, if the seed is set for every destination.
+    inline void setRandomSeed(const int seed) noexcept {
+        random.seed(seed);
+    }
+
+    inline void clearAssignmentData() noexcept {
+        assignmentData.clear();
+    }
+
+    // The penalties are used by all subsequent PAT computations of this worker, which bypass the PAT cache.
+    inline void setConnectionPenalties(const std::vector<PerceivedTime>* penalties) noexcept {
+        for (PATComputationType& pats : patComputations) {
+            pats.setConnectionPenalties(penalties);
+        }
+    }
+
+    // Precomputed transfers that are shared by the PAT computations of all workers (only used by TripBasedPATs).
+    inline void setTransfers(const TripTransfers* transfers) noexcept {
+        for (PATComputationType& pats : patComputations) {
+            pats.setTransfers(transfers);
+        }
+    }
+
+    inline const DemandCompaction& getDemandCompaction() const noexcept {
+        return demandCompaction;
+    }
+
 private:
+    inline PATComputationType& patComputation() noexcept {
+        return patComputations[currentPATs];
+    }
+
+    inline const PATComputationType& patComputation() const noexcept {
+        return patComputations[currentPATs];
+    }
+
+    // Returns true if the PATs have been loaded from the cache.
+    inline bool computePATs(PATComputationType& pats, const Vertex destinationVertex) const noexcept {
+        const bool useCache = patCache && !pats.hasConnectionPenalties();
+        if (useCache && patCache->load(pats, destinationVertex, settings.walkingCosts)) return true;
+        pats.run(destinationVertex, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+        if (useCache) patCache->store(pats, destinationVertex);
+        return false;
+    }
+
+    inline void assign(const Vertex destinationVertex, std::vector<AccumulatedVertexDemand::Entry>& demand, const PATComputationType& pats) noexcept {
+        AssertMsg(!demand.empty(), "Demand for destination vertex " << destinationVertex << " is empty!");
+        AssertMsg(data.isStop(destinationVertex) || reverseGraph.outDegree(destinationVertex) > 0, "Destination vertex " << destinationVertex << " is isolated!");
+        suppressUnusedParameterWarning(destinationVertex);
+
+        AssertMsg(pats.getPeriodicTimetable() == periodicTimetable, "PATs have been computed for a different timetable!");
+        AssertMsg(pats.getAccessWalking() == accessWalking, "PATs have been computed with a different access walking!");
+        sort(demand, [](const AccumulatedVertexDemand::Entry& a, const AccumulatedVertexDemand::Entry& b){return a.earliestDepartureTime < b.earliestDepartureTime;});
+        activePATs = &pats;
+
+        profiler.startInitialWalking();
+        if (settings.compactDemand) {
+            initializeAssignment(demandCompaction.compact(demand, settings.passengerMultiplier));
+        } else {
+            initializeAssignment(demand);
+        }
+        profiler.doneInitialWalking();
+        profiler.startAssignment();
+        if (periodicTimetable) {
+            for (const ConnectionId i : periodicTimetable->scanOrder()) {
+                profiler.assignConnection(periodicTimetable->originalConnection(i));
+                processConnection(i, periodicTimetable->connection(i));
+            }
+        } else {
+            for (const ConnectionId i : data.connectionIds()) {
+                profiler.assignConnection(i);
+                processConnection(i, data.connections[i]);
+            }
+        }
+        if (settings.compactDemand) demandCompaction.distributeGroups();
+        profiler.doneAssignment();
+    }
+
     inline void initializeAssignment(const std::vector<AccumulatedVertexDemand::Entry>& demand) noexcept {
         groupTrackingData.validate();
         for (const StopId stop : data.stops()) {
-            profiles[stop].initialize(patComputation.getProfile(stop));
+            profiles[stop].initialize(activePATs->getProfile(stop));
         }
         walkToInitialStops(demand);
         for (const StopId stop : data.stops()) {
@@ -204,11 +330,19 @@ private:
     inline ChoiceSet collectInitialWalkingChoices(const AccumulatedVertexDemand::Entry& demandEntry) noexcept {
         ChoiceSet choiceSet;
         bool foundInitialStop = false;
-        for (const Edge edge : data.transferGraph.edgesFrom(demandEntry.originVertex)) {
-            const Vertex initialStop = data.transferGraph.get(ToVertex, edge);
-            if (!data.isStop(initialStop)) continue;
-            evaluateInitialStop<DEPARTURE_TIME_CHOICE>(demandEntry, initialStop, data.transferGraph.get(TravelTime, edge), choiceSet);
-            foundInitialStop = true;
+        if (accessWalking) {
+            accessWalkingQuery->forEachStopFrom(demandEntry.originVertex, [&](const StopId initialStop, const int walkingTime) {
+                if (initialStop == demandEntry.originVertex) return;
+                evaluateInitialStop<DEPARTURE_TIME_CHOICE>(demandEntry, initialStop, walkingTime, choiceSet);
+                foundInitialStop = true;
+            });
+        } else {
+            for (const Edge edge : data.transferGraph.edgesFrom(demandEntry.originVertex)) {
+                const Vertex initialStop = data.transferGraph.get(ToVertex, edge);
+                if (!data.isStop(initialStop)) continue;
+                evaluateInitialStop<DEPARTURE_TIME_CHOICE>(demandEntry, initialStop, data.transferGraph.get(TravelTime, edge), choiceSet);
+                foundInitialStop = true;
+            }
         }
         if (data.isStop(demandEntry.originVertex)) {
             evaluateInitialStop<DEPARTURE_TIME_CHOICE>(demandEntry, demandEntry.originVertex, 0, choiceSet);
@@ -261,14 +395,16 @@ private:
         }
     }
 
-    inline void processConnection(const ConnectionId i) noexcept {
-        const CSA::Connection& connection = data.connections[i];
+    inline void processConnection(const ConnectionId i, const CSA::Connection& connection) noexcept {
         groupTrackingData.processOriginatingGroups(connection);
         groupTrackingData.processWalkingGroups(connection);
-        const ConnectionLabel& label = patComputation.connectionLabel(i);
-        const double targetPAT = patComputation.targetPAT(connection);
+        const ConnectionLabel& label = activePATs->connectionLabel(i);
+        const double targetPAT = activePATs->targetPAT(connection);
         const double hopOffPAT = std::min(targetPAT, label.transferPAT);
-        const double hopOnPAT = std::min(hopOffPAT, label.tripPAT);
+        // Boarding includes the penalty of connection i, as in the PAT computation. Groups that are already in the trip
+        // have traveled along connection i, and label.tripPAT includes the penalties of the following connections.
+        double hopOnPAT = std::min(hopOffPAT, label.tripPAT);
+        if (hopOnPAT < Unreachable) hopOnPAT += activePATs->connectionPenalty(i);
         moveGroups(groupTrackingData.groupsWaitingAtStop[connection.departureStopId], groupTrackingData.groupsInTrip[connection.tripId], label.skipPAT, hopOnPAT, "skip", "board");
         for (const GroupId group : groupTrackingData.groupsInTrip[connection.tripId]) {
             AssertMsg(group < assignmentData.connectionsPerGroup.size(), "Group " << group << " is out of bounds (0, " << assignmentData.connectionsPerGroup.size() << ")");
@@ -371,17 +507,26 @@ private:
     const CSA::TransferGraph& reverseGraph;
     const Settings& settings;
     const DecisionModel& decisionModel;
-
-    //PAT computation
-    PATComputationType patComputation;
+    const PATCache* patCache;
+    const CSA::PeriodicTimetable* periodicTimetable;
+    const AccessWalking* accessWalking;
+    std::unique_ptr<AccessWalking::Query> accessWalkingQuery;
+
+    //PAT computation (a second buffer is only allocated for pipelined execution)
+    std::vector<PATComputationType> patComputations;
+    size_t currentPATs;
+    const PATComputationType* activePATs;
     std::vector<ProfileReader> profiles;
 
     GroupTrackingData groupTrackingData;
     AssignmentData assignmentData;
 
     CycleRemoval cycleRemoval;
+    DemandCompaction demandCompaction;
     Random random;
     Profiler profiler;
+
+    std::unique_ptr<HelperThread> helper;
 };
 
 }
@@ -3,23 +3,32 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <limits>
+#include <algorithm>
+#include <memory>
 
 #include "../../DataStructures/Assignment/Profile.h"
 #include "../../DataStructures/Assignment/StopLabel.h"
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
 
 #include "../../Helpers/Vector/Vector.h"
 
+#include "AccessWalking.h"
+#include "PATFile.h"
 #include "Profiler.h"
 
 namespace Assignment {
 
+class TripTransfers;
+
 template<typename PROFILER = NoPATProfiler, bool USE_TRANSFER_BUFFER_TIMES = false>
 class ComputePATs {
 
 public:
     using Profiler = PROFILER;
     static constexpr bool UseTransferBufferTimes = USE_TRANSFER_BUFFER_TIMES;
+    static constexpr bool UsesTripTransfers = false;
     using Type = ComputePATs<Profiler, UseTransferBufferTimes>;
 
     struct ConnectionLabel {
@@ -28,6 +37,23 @@ public:
         PerceivedTime skipPAT{Unreachable};
     };
 
+private:
+    // Unshifted departure of a connection with the PAT of its departure stop, as stored for pulling footpaths.
+    struct DepartureEntry {
+        int departureTime;
+        ConnectionId connectionId;
+        PerceivedTime pat;
+    };
+
+    // Footpath to a stop whose departures are pulled. The cursor counts the departures of the stop that are reachable
+    // when arriving at the tail of the footpath at the time of the last evaluation.
+    struct Footpath {
+        StopId stop;
+        int walkingTime;
+        int offset; // walking time + buffer time
+        uint32_t cursor;
+    };
+
 public:
     ComputePATs(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Profiler& profiler = Profiler()) :
         data(data),
@@ -37,41 +63,103 @@ public:
         stopLabels(data.numberOfStops()),
         transferDistanceToTarget(data.numberOfStops(), INFTY),
         targetVertex(noVertex),
+        connectionPenalties(nullptr),
+        relaxationGraph(&reverseGraph),
+        periodicTimetable(nullptr),
+        accessWalking(nullptr),
+        pullFootpaths(false),
         profiler(profiler) {
     }
 
+    // Perceived time that is added for traveling along a connection, e.g. for crowding. Use nullptr to disable penalties.
+    inline void setConnectionPenalties(const std::vector<PerceivedTime>* penalties) noexcept {
+        AssertMsg(!penalties || penalties->size() == data.numberOfConnections(), "Number of connection penalties does not match the number of connections!");
+        connectionPenalties = penalties;
+    }
+
+    // Penalty that is added to the PAT of connection i, including all its arrival options
+    inline PerceivedTime connectionPenalty(const ConnectionId i) const noexcept {
+        return connectionPenalties ? (*connectionPenalties)[periodicTimetable ? periodicTimetable->originalConnection(i) : i] : 0;
+    }
+
+    inline bool hasConnectionPenalties() const noexcept {
+        return connectionPenalties;
+    }
+
+    // The footpaths are relaxed during the scan, so there are no precomputed transfers (see TripBasedPATs).
+    inline void setTransfers(const TripTransfers*) noexcept {}
+
+    // Reverse transfer graph restricted to edges between stops (see PreparedNetwork), which avoids scanning the edges to
+    // non-stop vertices during the relaxation. Use nullptr to relax the edges of the full reverse graph.
+    inline void setStopReverseGraph(const CSA::TransferGraph* stopReverseGraph) noexcept {
+        AssertMsg(!stopReverseGraph || stopReverseGraph->numVertices() == data.numberOfStops(), "Stop graph does not match the number of stops!");
+        relaxationGraph = stopReverseGraph ? stopReverseGraph : &reverseGraph;
+    }
+
+    // Instead of pushing the transfer entries of a departure to the profiles of all stops within walking distance, the
+    // departures are only stored at their stop and the footpaths are scanned when an arriving connection is evaluated.
+    // Pushing pays the degree per departure, pulling pays it per arrival, but with a cached cursor per footpath. The
+    // resulting PATs are the same.
+    inline void setPullFootpaths(const bool pull) noexcept {
+        pullFootpaths = pull;
+        if (!pullFootpaths || !footpathBegin.empty()) return;
+        departures.assign(data.numberOfStops(), std::vector<DepartureEntry>());
+        footpathBegin.emplace_back(0);
+        for (const StopId stop : data.stops()) {
+            footpaths.emplace_back(Footpath{stop, 0, data.minTransferTime(stop), 0});
+            for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                const Vertex neighbor = data.transferGraph.get(ToVertex, edge);
+                if (!data.isStop(neighbor)) continue;
+                const int travelTime = data.transferGraph.get(TravelTime, edge);
+                footpaths.emplace_back(Footpath{StopId(neighbor), travelTime, travelTime + (UseTransferBufferTimes ? data.minTransferTime(StopId(neighbor)) : 0), 0});
+            }
+            footpathBegin.emplace_back(footpaths.size());
+        }
+    }
+
+    inline bool usesPullFootpaths() const noexcept {
+        return pullFootpaths;
+    }
+
+    // Scans the connections of a periodic timetable, including the copies of the next day (see CSA::PeriodicTimetable),
+    // such that the connection labels are indexed by the connection ids of the timetable. Use nullptr to scan only the
+    // connections of the data.
+    inline void setPeriodicTimetable(const CSA::PeriodicTimetable* timetable) noexcept {
+        periodicTimetable = timetable;
+        connectionLabels.assign(periodicTimetable ? periodicTimetable->numberOfConnections() : data.numberOfConnections(), ConnectionLabel());
+        tripPAT.assign(periodicTimetable ? periodicTimetable->numberOfTrips() : data.numberOfTrips(), Unreachable);
+    }
+
+    inline const CSA::PeriodicTimetable* getPeriodicTimetable() const noexcept {
+        return periodicTimetable;
+    }
+
+    // The final walking to the target follows shortest paths of the transfer graph (see AccessWalking) instead of the
+    // edges into the target. Use nullptr to use only the edges.
+    inline void setAccessWalking(const AccessWalking* walking) noexcept {
+        if (reverseGraph.isVertex(targetVertex)) cleanUp();
+        targetVertex = noVertex;
+        accessWalking = walking;
+        accessWalkingQuery = accessWalking ? std::make_unique<AccessWalking::Query>(*accessWalking) : nullptr;
+    }
+
+    inline const AccessWalking* getAccessWalking() const noexcept {
+        return accessWalking;
+    }
+
     inline void run(const Vertex target, const int maxDelay, const int transferCost, const double walkingCosts = 0.0, const double waitingCosts = 0.0) noexcept {
         profiler.startInitialization();
         clear();
         initialize(target, walkingCosts);
         profiler.doneInitialization();
-        for (ConnectionId i = ConnectionId(data.numberOfConnections() - 1); i < data.numberOfConnections(); i--) {
-            profiler.scanConnection(i);
-            const CSA::Connection& connection = data.connections[i];
-            const ProfileEntry& skipEntry = stopLabels[connection.departureStopId].getSkipEntry();
-
-            AssertMsg(skipEntry.departureTime >= connection.departureTime, "Connections are scanned out of order (" << skipEntry.departureTime << " before " << connection.departureTime << ", index: " << i << ")!");
-            connectionLabels[i].tripPAT = tripPAT[connection.tripId];
-            connectionLabels[i].transferPAT = stopLabels[connection.arrivalStopId].evaluateWithDelay(connection.arrivalTime, maxDelay, waitingCosts) + transferCost;
-            connectionLabels[i].skipPAT = skipEntry.evaluate(connection.departureTime, waitingCosts);
-            profiler.evaluateProfile();
-
-            const PerceivedTime pat = std::min(std::min(connectionLabels[i].tripPAT, targetPAT(connection)), connectionLabels[i].transferPAT);
-            tripPAT[connection.tripId] = pat;
-            if (pat >= connectionLabels[i].skipPAT) continue;
-
-            AssertMsg(pat < Unreachable, "Adding infinity PAT = " << pat << "!");
-            stopLabels[connection.departureStopId].addWaitingEntry(ProfileEntry(connection.departureTime, i, pat, waitingCosts));
-            profiler.addToProfile();
-            const int bufferTime = data.minTransferTime(connection.departureStopId);
-            profiler.insertToProfile();
-            stopLabels[connection.departureStopId].addTransferEntry(ProfileEntry(connection.departureTime, i, pat, 0, bufferTime, walkingCosts, waitingCosts), profiler);
-            for (const Edge edge : reverseGraph.edgesFrom(connection.departureStopId)) {
-                const Vertex from = reverseGraph.get(ToVertex, edge);
-                if (!data.isStop(from)) continue;
-                profiler.insertToProfile();
-                stopLabels[from].addTransferEntry(ProfileEntry(connection.departureTime, i, pat, reverseGraph.get(TravelTime, edge), UseTransferBufferTimes ? bufferTime : 0, walkingCosts, waitingCosts), profiler);
-                profiler.relaxEdge(edge);
+        if (periodicTimetable) {
+            const std::vector<ConnectionId>& order = periodicTimetable->scanOrder();
+            for (size_t j = order.size() - 1; j < order.size(); j--) {
+                scanConnection(order[j], periodicTimetable->connection(order[j]), maxDelay, transferCost, walkingCosts, waitingCosts);
+            }
+        } else {
+            for (ConnectionId i = ConnectionId(data.numberOfConnections() - 1); i < data.numberOfConnections(); i--) {
+                scanConnection(i, data.connections[i], maxDelay, transferCost, walkingCosts, waitingCosts);
             }
         }
     }
@@ -93,30 +181,152 @@ public:
         return profiler;
     }
 
+    // Writes the result of the last run, i.e., the connection labels that differ from the default label and the waiting profiles.
+    inline void writeBinary(const std::string& fileName) const noexcept {
+        PATFile::Write(fileName, targetVertex, connectionLabels, data.numberOfStops(), [&](const StopId stop) -> const Profile& {
+            return getProfile(stop);
+        });
+    }
+
+    // Restores the result of a run for the given target from a file written by writeBinary().
+    inline void readBinary(const std::string& fileName, const Vertex target, const double walkingCosts = 0.0) noexcept {
+        clear();
+        initialize(target, walkingCosts);
+        const PATFile file(fileName);
+        Ensure(file.target() == target, "File " << fileName << " contains PATs for target " << file.target() << " instead of " << target << "!");
+        Ensure(file.numberOfStops() == data.numberOfStops(), "File " << fileName << " was computed for a different network!");
+        file.readConnectionLabels(connectionLabels);
+        Profile profile;
+        for (const StopId stop : data.stops()) {
+            file.readProfile(stop, profile);
+            stopLabels[stop].setWaitingProfile(profile.begin(), profile.end());
+        }
+    }
+
 private:
     inline void clear() noexcept {
         Vector::fill(tripPAT, Unreachable);
         Vector::fill(stopLabels);
+        if (pullFootpaths) {
+            for (std::vector<DepartureEntry>& departuresOfStop : departures) {
+                departuresOfStop.clear();
+            }
+        }
         if (reverseGraph.isVertex(targetVertex)) cleanUp();
     }
 
     inline void initialize(const Vertex target, const double walkingCosts = 0.0) noexcept {
         targetVertex = target;
-        for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
-            profiler.relaxEdge(edge);
-            const Vertex stop = reverseGraph.get(ToVertex, edge);
-            if (!data.isStop(stop)) continue;
-            transferDistanceToTarget[stop] = (walkingCosts + 1) * reverseGraph.get(TravelTime, edge);
+        if (accessWalking) {
+            accessWalkingQuery->forEachStopTo(targetVertex, [&](const StopId stop, const int walkingTime) {
+                transferDistanceToTarget[stop] = (walkingCosts + 1) * walkingTime;
+            });
+        } else {
+            for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
+                profiler.relaxEdge(edge);
+                const Vertex stop = reverseGraph.get(ToVertex, edge);
+                if (!data.isStop(stop)) continue;
+                transferDistanceToTarget[stop] = (walkingCosts + 1) * reverseGraph.get(TravelTime, edge);
+            }
         }
         if (data.isStop(targetVertex)) transferDistanceToTarget[targetVertex] = 0;
     }
 
-    inline void cleanUp() noexcept {
-        for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
+    inline void scanConnection(const ConnectionId i, const CSA::Connection& connection, const int maxDelay, const int transferCost, const double walkingCosts, const double waitingCosts) noexcept {
+        profiler.scanConnection(i);
+        const ProfileEntry& skipEntry = stopLabels[connection.departureStopId].getSkipEntry();
+
+        AssertMsg(skipEntry.departureTime >= connection.departureTime, "Connections are scanned out of order (" << skipEntry.departureTime << " before " << connection.departureTime << ", index: " << i << ")!");
+        connectionLabels[i].tripPAT = tripPAT[connection.tripId];
+        connectionLabels[i].transferPAT = (pullFootpaths ? pullTransferPAT(connection.arrivalStopId, connection.arrivalTime, maxDelay, walkingCosts, waitingCosts) : stopLabels[connection.arrivalStopId].evaluateWithDelay(connection.arrivalTime, maxDelay, waitingCosts)) + transferCost;
+        connectionLabels[i].skipPAT = skipEntry.evaluate(connection.departureTime, waitingCosts);
+        profiler.evaluateProfile();
+
+        PerceivedTime pat = std::min(std::min(connectionLabels[i].tripPAT, targetPAT(connection)), connectionLabels[i].transferPAT);
+        if (pat < Unreachable) pat += connectionPenalty(i);
+        tripPAT[connection.tripId] = pat;
+        if (pat >= connectionLabels[i].skipPAT) return;
+
+        AssertMsg(pat < Unreachable, "Adding infinity PAT = " << pat << "!");
+        stopLabels[connection.departureStopId].addWaitingEntry(ProfileEntry(connection.departureTime, i, pat, waitingCosts));
+        profiler.addToProfile();
+        if (pullFootpaths) {
+            std::vector<DepartureEntry>& departuresOfStop = departures[connection.departureStopId];
+            if (!departuresOfStop.empty() && departuresOfStop.back().departureTime == connection.departureTime) {
+                departuresOfStop.back() = DepartureEntry{connection.departureTime, i, pat};
+            } else {
+                departuresOfStop.emplace_back(DepartureEntry{connection.departureTime, i, pat});
+            }
+            return;
+        }
+        const int bufferTime = data.minTransferTime(connection.departureStopId);
+        profiler.insertToProfile();
+        stopLabels[connection.departureStopId].addTransferEntry(ProfileEntry(connection.departureTime, i, pat, 0, bufferTime, walkingCosts, waitingCosts), profiler);
+        // Footpaths are relaxed with a single hop, so the transfer graph has to be transitively closed: The transfer
+        // profile of a stop is evaluated with the delay distribution as a whole, which cannot be split into the
+        // profiles of intermediate vertices (e.g., the hubs of a contraction hierarchy). Use the walking time and
+        // edge bounds of parseCSAFromCSV to limit the size of the closure.
+        for (const Edge edge : relaxationGraph->edgesFrom(connection.departureStopId)) {
+            const Vertex from = relaxationGraph->get(ToVertex, edge);
+            if (!data.isStop(from)) continue;
+            profiler.insertToProfile();
+            stopLabels[from].addTransferEntry(ProfileEntry(connection.departureTime, i, pat, relaxationGraph->get(TravelTime, edge), UseTransferBufferTimes ? bufferTime : 0, walkingCosts, waitingCosts), profiler);
             profiler.relaxEdge(edge);
-            const Vertex stop = reverseGraph.get(ToVertex, edge);
-            if (!data.isStop(stop)) continue;
-            transferDistanceToTarget[stop] = INFTY;
+        }
+    }
+
+    // Evaluates the transfer profile of the stop without materializing it: Every footpath contributes the departures of
+    // its head stop that lie within [time, time + maxDelay) after walking and buffering, and the first one after that.
+    // Together, these contain all entries of the Pareto front that evaluateWithDelay() scans.
+    inline PerceivedTime pullTransferPAT(const StopId stop, const int time, const int maxDelay, const double walkingCosts, const double waitingCosts) noexcept {
+        if (maxDelay <= 0) {
+            // Only the first reachable departure of every footpath matters
+            PerceivedTime pat = std::numeric_limits<PerceivedTime>::infinity();
+            for (size_t i = footpathBegin[stop]; i < footpathBegin[size_t(stop) + 1]; i++) {
+                profiler.relaxEdge(Edge(i));
+                const std::vector<DepartureEntry>& departuresOfStop = departures[footpaths[i].stop];
+                const uint32_t cursor = moveCursor(footpaths[i], departuresOfStop, time);
+                if (cursor == 0) continue;
+                const DepartureEntry& departure = departuresOfStop[cursor - 1];
+                pat = std::min(pat, ProfileEntry(departure.departureTime, departure.connectionId, departure.pat, footpaths[i].walkingTime, footpaths[i].offset - footpaths[i].walkingTime, walkingCosts, waitingCosts).evaluate(time, waitingCosts));
+            }
+            return pat;
+        }
+        candidates.clear();
+        for (size_t i = footpathBegin[stop]; i < footpathBegin[size_t(stop) + 1]; i++) {
+            profiler.relaxEdge(Edge(i));
+            const std::vector<DepartureEntry>& departuresOfStop = departures[footpaths[i].stop];
+            for (size_t j = moveCursor(footpaths[i], departuresOfStop, time); j-- > 0;) {
+                const DepartureEntry& departure = departuresOfStop[j];
+                candidates.emplace_back(departure.departureTime, departure.connectionId, departure.pat, footpaths[i].walkingTime, footpaths[i].offset - footpaths[i].walkingTime, walkingCosts, waitingCosts);
+                if (departure.departureTime - footpaths[i].offset >= time + maxDelay) break;
+            }
+        }
+        return StopLabel::evaluateWithDelay(candidates, transferProfile, time, maxDelay, waitingCosts);
+    }
+
+    // Departures are appended in descending order and the arrival times of consecutive evaluations are similar, so the
+    // cursor moves only a few steps. Cursors are not reset between runs, but clamped to the departures of the current run.
+    inline static uint32_t moveCursor(Footpath& footpath, const std::vector<DepartureEntry>& departuresOfStop, const int time) noexcept {
+        uint32_t& cursor = footpath.cursor;
+        if (cursor > departuresOfStop.size()) cursor = departuresOfStop.size();
+        while (cursor < departuresOfStop.size() && departuresOfStop[cursor].departureTime - footpath.offset >= time) cursor++;
+        while (cursor > 0 && departuresOfStop[cursor - 1].departureTime - footpath.offset < time) cursor--;
+        return cursor;
+    }
+
+    inline void cleanUp() noexcept {
+        if (accessWalking) {
+            accessWalkingQuery->forEachStopTo(targetVertex, [&](const StopId stop, const int) {
+                transferDistanceToTarget[stop] = INFTY;
+            });
+        } else {
+            for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
+                profiler.relaxEdge(edge);
+                const Vertex stop = reverseGraph.get(ToVertex, edge);
+                if (!data.isStop(stop)) continue;
+                transferDistanceToTarget[stop] = INFTY;
+            }
         }
         if (data.isStop(targetVertex)) transferDistanceToTarget[targetVertex] = INFTY;
     }
@@ -130,6 +340,19 @@ private:
     std::vector<StopLabel> stopLabels;
     std::vector<int> transferDistanceToTarget;
     Vertex targetVertex;
+    const std::vector<PerceivedTime>* connectionPenalties;
+    const CSA::TransferGraph* relaxationGraph;
+    const CSA::PeriodicTimetable* periodicTimetable;
+    const AccessWalking* accessWalking;
+    std::unique_ptr<AccessWalking::Query> accessWalkingQuery;
+
+    bool pullFootpaths;
+    std::vector<std::vector<DepartureEntry>> departures;
+    // Footpaths between stops by tail stop, starting with a footpath from the stop to itself
+    std::vector<size_t> footpathBegin;
+    std::vector<Footpath> footpaths;
+    std::vector<ProfileEntry> candidates;
+    Profile transferProfile;
 
     Profiler profiler;
 
@@ -7,6 +7,7 @@
 #include "../../DataStructures/Assignment/Settings.h"
 #include "../../DataStructures/CSA/Data.h"
 #include "../../DataStructures/CSA/Entities/Connection.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
 
 
 namespace Assignment {
@@ -35,22 +36,28 @@ private:
     };
 
 public:
-    CycleRemoval(const CSA::Data& data, const int mode, AssignmentData& assignmentData) :
+    // stationByStop: precomputed result of computeStationByStop(data), only used for mode == RemoveStationCycles.
+    // periodicTimetable: the connections of the groups are ids of the periodic timetable, which are replaced by the ids
+    // of the original connections.
+    CycleRemoval(const CSA::Data& data, const int mode, AssignmentData& assignmentData, const std::vector<StopId>* stationByStop = nullptr, const CSA::PeriodicTimetable* periodicTimetable = nullptr) :
         data(data),
+        periodicTimetable(periodicTimetable),
         mode(mode),
         assignmentData(assignmentData),
-        stationByStop(data.numberOfStops(), noStop),
+        stationByStop((mode != RemoveStationCycles) ? std::vector<StopId>(data.numberOfStops(), noStop) : stationByStop ? *stationByStop : computeStationByStop(data)),
         stopCycleIndex(data.numberOfStops(), size_t(-1)),
         removedCycleConnections(0),
         removedCycles(0) {
-        if (mode == RemoveStationCycles) {
-            for (const StopId stop : data.stops()) {
-                stationByStop[stop] = stop;
-                for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
-                    stationByStop[stop] = std::min<StopId>(stationByStop[stop], StopId(data.transferGraph.get(ToVertex, edge)));
-                }
-            }
+        AssertMsg(this->stationByStop.size() == data.numberOfStops(), "Station mapping does not match the number of stops!");
+    }
+
+    // Every stop is represented by the smallest stop id within its transfer graph neighborhood.
+    inline static std::vector<StopId> computeStationByStop(const CSA::Data& data) noexcept {
+        std::vector<StopId> stationByStop(data.numberOfStops(), noStop);
+        for (const StopId stop : data.stops()) {
+            stationByStop[stop] = data.station(stop);
         }
+        return stationByStop;
     }
 
     inline void run() noexcept {
@@ -83,7 +90,25 @@ public:
     }
 
 private:
+    inline CSA::Connection getConnection(const ConnectionId i) const noexcept {
+        return periodicTimetable ? periodicTimetable->connection(i) : data.connections[i];
+    }
+
+    inline ConnectionId originalConnection(const ConnectionId i) const noexcept {
+        return periodicTimetable ? periodicTimetable->originalConnection(i) : i;
+    }
+
+    inline void foldConnections(std::vector<ConnectionId>& connections) const noexcept {
+        if (!periodicTimetable) return;
+        for (ConnectionId& i : connections) {
+            i = periodicTimetable->originalConnection(i);
+        }
+    }
+
     inline void keepCycles() noexcept {
+        for (std::vector<ConnectionId>& connections : assignmentData.connectionsPerGroup) {
+            foldConnections(connections);
+        }
         assignmentData.addGroupsToConnections();
     }
 
@@ -93,19 +118,19 @@ private:
             if (connections.empty()) continue;
             const size_t size = connections.size();
             for (size_t i = connections.size() - 1; i < size; i--) {
-                const CSA::Connection& connection = data.connections[connections[i]];
+                const CSA::Connection connection = getConnection(connections[i]);
                 stopCycleIndex[connection.departureStopId] = i;
                 stopCycleIndex[connection.arrivalStopId] = i + 1;
             } // stopCycleIndex[x] holds the index of the first connection used after visiting x <=> (stopCycleIndex[x] - 1) is the index of the first connection reaching x
             std::vector<ConnectionId> usedConnections;
             for (size_t i = connections.size() - 1; i < size; i--) {
-                AssertMsg(stopCycleIndex[data.connections[connections[i]].arrivalStopId] - 1 <= i, "Increasing path index at arrival stop from " << i << " to " << (stopCycleIndex[data.connections[connections[i]].arrivalStopId] - 1) << "!");
-                i = stopCycleIndex[data.connections[connections[i]].arrivalStopId] - 1;
+                AssertMsg(stopCycleIndex[getConnection(connections[i]).arrivalStopId] - 1 <= i, "Increasing path index at arrival stop from " << i << " to " << (stopCycleIndex[getConnection(connections[i]).arrivalStopId] - 1) << "!");
+                i = stopCycleIndex[getConnection(connections[i]).arrivalStopId] - 1;
                 if (i >= size) break;
-                assignmentData.groupsPerConnection[connections[i]].emplace_back(group);
+                assignmentData.groupsPerConnection[originalConnection(connections[i])].emplace_back(group);
                 usedConnections.emplace_back(connections[i]);
-                AssertMsg(stopCycleIndex[data.connections[connections[i]].departureStopId] <= i, "Increasing path index at departure stop from " << i << " to " << (stopCycleIndex[data.connections[connections[i]].departureStopId]) << "!");
-                i = stopCycleIndex[data.connections[connections[i]].departureStopId];
+                AssertMsg(stopCycleIndex[getConnection(connections[i]).departureStopId] <= i, "Increasing path index at departure stop from " << i << " to " << (stopCycleIndex[getConnection(connections[i]).departureStopId]) << "!");
+                i = stopCycleIndex[getConnection(connections[i]).departureStopId];
             }
             Vector::reverse(usedConnections);
             if (usedConnections.empty()) {
@@ -115,6 +140,7 @@ private:
                 removedCycleConnections += (connections.size() - usedConnections.size());
                 removedCycles++;
             }
+            foldConnections(usedConnections);
             usedConnections.swap(connections);
         }
     }
@@ -125,18 +151,18 @@ private:
             AssertMsg(path.empty(), "Path contains stations from a previous iteration!");
             std::vector<ConnectionId>& connections = assignmentData.connectionsPerGroup[group];
             if (connections.empty()) continue;
-            PathLabel label(data.connections[connections.front()], stationByStop);
+            PathLabel label(getConnection(connections.front()), stationByStop);
             path.emplace_back(label.station);
             for (const size_t i : indices(connections)) {
                 stopCycleIndex[path.back()] = i; // Integer array of |stations| size, Contains last appearance index of every station in the journey-path
-                path.emplace_back(stationByStop[data.connections[connections[i]].arrivalStopId]); // journey represented as sequence of stations
+                path.emplace_back(stationByStop[getConnection(connections[i]).arrivalStopId]); // journey represented as sequence of stations
             }
             size_t i = 0; // real (cycle free) starting index of the journey-path
             if (stopCycleIndex[label.station] > i) { // first station of the journey-path is part of a cycle
                 size_t j = stopCycleIndex[label.station]; // potential real start index of the (cycle free) journey
                 while (j > i) {
                     if (path[j] == path[i]) { // check if skipping the cycle yields a valid journey
-                        const CSA::Connection& nextConnection = data.connections[connections[j]];
+                        const CSA::Connection nextConnection = getConnection(connections[j]);
                         if ((nextConnection.tripId != label.trip) && (data.isCombinable<false>(label.stop, label.time, nextConnection))) break;
                     }
                     j--;
@@ -145,9 +171,9 @@ private:
             }
             std::vector<ConnectionId> usedConnections;
             while (i < connections.size()) {
-                const CSA::Connection& connection = data.connections[connections[i]];
+                const CSA::Connection connection = getConnection(connections[i]);
                 if ((label.station == path.back()) && (label.trip != connection.tripId)) break; // if you can reach the destination by walking => do not board a new trip
-                assignmentData.groupsPerConnection[connections[i]].emplace_back(group);
+                assignmentData.groupsPerConnection[originalConnection(connections[i])].emplace_back(group);
                 usedConnections.emplace_back(connections[i]);
                 i++;
                 if (i >= connections.size()) break;
@@ -156,7 +182,7 @@ private:
                     size_t j = stopCycleIndex[label.station];
                     while (j > i) {
                         if (path[j] == path[i]) {
-                            const CSA::Connection& nextConnection = data.connections[connections[j]];
+                            const CSA::Connection nextConnection = getConnection(connections[j]);
                             if ((nextConnection.tripId != label.trip) && (data.isCombinable<true>(label.stop, label.time, nextConnection))) break;
                         }
                         j--;
@@ -171,6 +197,7 @@ private:
                 removedCycleConnections += (connections.size() - usedConnections.size());
                 removedCycles++;
             }
+            foldConnections(usedConnections);
             usedConnections.swap(connections);
             path.clear();
         }
@@ -178,6 +205,7 @@ private:
 
 private:
     const CSA::Data& data;
+    const CSA::PeriodicTimetable* periodicTimetable;
     const int mode;
     AssignmentData& assignmentData;
 
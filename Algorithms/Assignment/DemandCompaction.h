@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "../../DataStructures/Assignment/AssignmentData.h"
+#include "../../DataStructures/Assignment/GroupData.h"
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Demand/AccumulatedVertexDemand.h"
+
+namespace Assignment {
+
+// Merges demand entries that are indistinguishable for the assignment, i.e., entries with the same destination and
+// departure window whose origins are connected to the same stops with the same transfer times. The merged entries are
+// assigned as a single group. Afterwards, distributeGroups() splits the resulting groups such that every group belongs
+// to exactly one of the original demand entries again.
+class DemandCompaction {
+private:
+    struct Member {
+        Member(const size_t demandIndex = -1, const double numberOfPassengers = 0) :
+            demandIndex(demandIndex),
+            numberOfPassengers(numberOfPassengers) {
+        }
+        size_t demandIndex;
+        double numberOfPassengers;
+    };
+
+    using AccessSignature = std::vector<std::pair<Vertex, int>>;
+    using DemandKey = std::tuple<size_t, Vertex, int, int>;
+
+public:
+    DemandCompaction(const CSA::Data& data, AssignmentData& assignmentData) :
+        data(data),
+        assignmentData(assignmentData),
+        accessClassOfVertex(data.transferGraph.numVertices(), size_t(-1)),
+        firstGroup(0),
+        numberOfOriginalEntries(0),
+        numberOfCompactedEntries(0) {
+    }
+
+    // The demandIndex of each compacted entry refers to its member list, the original indices are restored by distributeGroups().
+    inline const std::vector<AccumulatedVertexDemand::Entry>& compact(const std::vector<AccumulatedVertexDemand::Entry>& demand, const int passengerMultiplier) noexcept {
+        compactedDemand.clear();
+        members.clear();
+        Map<DemandKey, size_t> entryByKey;
+        for (const AccumulatedVertexDemand::Entry& entry : demand) {
+            const DemandKey key(getAccessClass(entry.originVertex), entry.destinationVertex, entry.earliestDepartureTime, entry.latestDepartureTime);
+            if (!entryByKey.contains(key)) {
+                entryByKey.insert(key, compactedDemand.size());
+                compactedDemand.emplace_back(entry);
+                compactedDemand.back().demandIndex = members.size();
+                compactedDemand.back().numberOfPassengers = 0;
+                members.emplace_back();
+            }
+            AccumulatedVertexDemand::Entry& compactedEntry = compactedDemand[entryByKey[key]];
+            compactedEntry.numberOfPassengers += entry.numberOfPassengers;
+            members[compactedEntry.demandIndex].emplace_back(entry.demandIndex, entry.numberOfPassengers * passengerMultiplier);
+        }
+        firstGroup = assignmentData.groups.size();
+        numberOfOriginalEntries += demand.size();
+        numberOfCompactedEntries += compactedDemand.size();
+        return compactedDemand;
+    }
+
+    // Has to be called after the groups of the compacted demand have been assigned. Each group is split greedily among the
+    // members of its compacted entry, such that every member receives exactly its own number of passengers.
+    inline void distributeGroups() noexcept {
+        const GroupId endGroup = assignmentData.groups.size();
+        std::vector<bool> isUnassigned(endGroup - firstGroup, false);
+        for (const GroupId group : assignmentData.unassignedGroups) {
+            if (group >= firstGroup) isUnassigned[group - firstGroup] = true;
+        }
+        std::vector<bool> isDirectWalking(endGroup - firstGroup, false);
+        for (const GroupId group : assignmentData.directWalkingGroups) {
+            if (group >= firstGroup) isDirectWalking[group - firstGroup] = true;
+        }
+        std::vector<size_t> currentMember(members.size(), 0);
+        for (GroupId group = firstGroup; group < endGroup; group++) {
+            const size_t compactedIndex = assignmentData.groups[group].demandIndex;
+            AssertMsg(compactedIndex < members.size(), "Group " << group << " does not belong to a compacted demand entry!");
+            while (true) {
+                AssertMsg(currentMember[compactedIndex] < members[compactedIndex].size(), "Compacted demand entry " << compactedIndex << " has more passengers than its members!");
+                Member& member = members[compactedIndex][currentMember[compactedIndex]];
+                if (assignmentData.groups[group].groupSize > member.numberOfPassengers) {
+                    const GroupId newGroup = assignmentData.splitGroup(group, member.numberOfPassengers);
+                    assignmentData.groups[newGroup].demandIndex = member.demandIndex;
+                    if (isUnassigned[group - firstGroup]) assignmentData.unassignedGroups.emplace_back(newGroup);
+                    if (isDirectWalking[group - firstGroup]) assignmentData.directWalkingGroups.emplace_back(newGroup);
+                    currentMember[compactedIndex]++;
+                } else {
+                    assignmentData.groups[group].demandIndex = member.demandIndex;
+                    member.numberOfPassengers -= assignmentData.groups[group].groupSize;
+                    if (member.numberOfPassengers <= 0) currentMember[compactedIndex]++;
+                    break;
+                }
+            }
+        }
+    }
+
+    inline size_t getNumberOfOriginalEntries() const noexcept {
+        return numberOfOriginalEntries;
+    }
+
+    inline size_t getNumberOfCompactedEntries() const noexcept {
+        return numberOfCompactedEntries;
+    }
+
+private:
+    inline size_t getAccessClass(const Vertex vertex) noexcept {
+        if (accessClassOfVertex[vertex] != size_t(-1)) return accessClassOfVertex[vertex];
+        AccessSignature signature;
+        for (const Edge edge : data.transferGraph.edgesFrom(vertex)) {
+            const Vertex stop = data.transferGraph.get(ToVertex, edge);
+            if (!data.isStop(stop)) continue;
+            signature.emplace_back(stop, data.transferGraph.get(TravelTime, edge));
+        }
+        if (data.isStop(vertex)) signature.emplace_back(vertex, 0);
+        std::sort(signature.begin(), signature.end());
+        if (!accessClassBySignature.contains(signature)) {
+            accessClassBySignature.insert(signature, accessClassBySignature.size());
+        }
+        accessClassOfVertex[vertex] = accessClassBySignature[signature];
+        return accessClassOfVertex[vertex];
+    }
+
+private:
+    const CSA::Data& data;
+    AssignmentData& assignmentData;
+
+    Map<AccessSignature, size_t> accessClassBySignature;
+    std::vector<size_t> accessClassOfVertex;
+
+    std::vector<AccumulatedVertexDemand::Entry> compactedDemand;
+    std::vector<std::vector<Member>> members;
+    GroupId firstGroup;
+
+    size_t numberOfOriginalEntries;
+    size_t numberOfCompactedEntries;
+};
+
+}
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "../../DataStructures/Assignment/AssignmentData.h"
@@ -9,8 +15,10 @@
 #include "../../DataStructures/Assignment/GroupAssignmentStatistic.h"
 #include "../../DataStructures/Assignment/GroupData.h"
 #include "../../DataStructures/Assignment/JourneyWriter.h"
+#include "../../DataStructures/Assignment/LoadStatistics.h"
 #include "../../DataStructures/Assignment/Settings.h"
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
 #include "../../DataStructures/Demand/AccumulatedVertexDemand.h"
 #include "../../DataStructures/Demand/IdVertexDemand.h"
 #include "../../DataStructures/Demand/SplitDemand.h"
@@ -21,21 +29,27 @@
 #include "../../Helpers/MultiThreading.h"
 #include "../../Helpers/Vector/Vector.h"
 
+#include "AccessWalking.h"
+#include "AssignmentBundle.h"
+#include "AssignmentStore.h"
 #include "AssignmentWorker.h"
 #include "CycleRemoval.h"
+#include "PATCache.h"
+#include "PreparedNetwork.h"
 #include "Profiler.h"
 
 namespace Assignment {
 
-template<typename DECISION_MODEL, typename PROFILER, bool USE_TRANSFER_BUFFER_TIMES = false>
+template<typename DECISION_MODEL, typename PROFILER, bool USE_TRANSFER_BUFFER_TIMES = false, typename PAT_COMPUTATION = ComputePATs<NoPATProfiler, USE_TRANSFER_BUFFER_TIMES>>
 class GroupAssignment {
 
 public:
     using DecisionModel = DECISION_MODEL;
     using Profiler = PROFILER;
     constexpr static inline bool UseTransferBufferTimes = USE_TRANSFER_BUFFER_TIMES;
-    using Type = GroupAssignment<DecisionModel, Profiler, UseTransferBufferTimes>;
-    using WorkerType = AssignmentWorker<DecisionModel, Profiler, UseTransferBufferTimes>;
+    using Type = GroupAssignment<DecisionModel, Profiler, UseTransferBufferTimes, PAT_COMPUTATION>;
+    using WorkerType = AssignmentWorker<DecisionModel, Profiler, UseTransferBufferTimes, PAT_COMPUTATION>;
+    using DemandByDestination = SplitDemand<AccumulatedVertexDemand::Entry>;
 
 public:
     GroupAssignment(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Settings& settings) :
@@ -45,42 +59,517 @@ public:
         decisionModel(settings),
         assignmentData(data.numberOfConnections()),
         removedCycleConnections(0),
-        removedCycles(0) {
+        removedCycles(0),
+        preparedNetwork(nullptr),
+        periodicTimetable(settings.periodicTimetable ? std::make_unique<CSA::PeriodicTimetable>(data, 24 * 60 * 60, settings.periodicHorizon) : nullptr),
+        accessWalking(settings.chAccessWalking ? std::make_unique<AccessWalking>(data, settings.maxAccessWalkingTime) : nullptr) {
+        // Merging destinations and compacting demand compare the transfer edges of the zones
+        Ensure(!settings.chAccessWalking || (!settings.mergeEquivalentDestinations && !settings.compactDemand), "CH access walking cannot be combined with merged destinations or compacted demand!");
         profiler.initialize(data);
     }
 
-    inline void run(const AccumulatedVertexDemand& demand, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+    // The split only depends on the demand settings, so it can be reused by assignments with the same demand settings.
+    inline DemandByDestination splitDemand(const AccumulatedVertexDemand& demand) const noexcept {
+        return AssignmentBundle::Split(data, reverseGraph, demand, settings);
+    }
+
+    // The prepared network has to be derived from the same data and is used by all subsequent runs.
+    inline void usePreparedNetwork(const PreparedNetwork* network) noexcept {
+        AssertMsg(!network || network->stationByStop.size() == data.numberOfStops(), "Prepared network does not match the number of stops!");
+        preparedNetwork = network;
+    }
+
+    // PATs are loaded from/stored to <directory> by all subsequent runs.
+    inline void enablePATCache(const std::string& directory, const std::string& csaFileName) noexcept {
+        patCache = PATCache(directory, csaFileName, settings, UseTransferBufferTimes);
+    }
+
+    // usePipeline: Every worker is accompanied by a helper thread (pinned to the core of the worker + helperCoreOffset),
+    // which computes the PATs for the next destination while the current destination is assigned.
+    inline void run(const AccumulatedVertexDemand& demand, const int numberOfThreads = 1, const int pinMultiplier = 1, const bool usePipeline = false, const int helperCoreOffset = 1) noexcept {
+        DemandByDestination demandByDestination = splitDemand(demand);
+        run(demandByDestination, numberOfThreads, pinMultiplier, usePipeline, helperCoreOffset);
+    }
+
+    // Runs the assignment for demand that has already been split with splitDemand(). The demand entries of every
+    // destination are reordered by the workers.
+    inline void run(DemandByDestination& demandByDestination, const int numberOfThreads = 1, const int pinMultiplier = 1, const bool usePipeline = false, const int helperCoreOffset = 1) noexcept {
         profiler.start();
         clear();
-        SplitDemand<AccumulatedVertexDemand::Entry> demandByDestination(Construct::SplitByDestination, data, reverseGraph, demand.entries, settings.allowDepartureStops);
 
         const int numCores = numberOfCores();
+        std::atomic<size_t> nextDestinationIndex(0);
         omp_set_num_threads(numberOfThreads);
+        prepareTransfers();
         #pragma omp parallel
         {
             srand(settings.randomSeed);
+            int threadId = omp_get_thread_num();
+            const int coreId = (threadId * pinMultiplier) % numCores;
+            pinThreadToCoreId(coreId);
+            AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
+
+            WorkerType worker(data, reverseGraph, settings, decisionModel, usePipeline ? 2 : 1, getPATCache(), preparedNetwork, periodicTimetable.get(), accessWalking.get());
+            worker.setTransfers(getTransfers());
+
+            if (usePipeline) {
+                size_t i = nextDestinationIndex++;
+                if (i < demandByDestination.size()) {
+                    worker.startPipeline(demandByDestination.vertexAtIndex(i), (coreId + helperCoreOffset) % numCores);
+                }
+                while (i < demandByDestination.size()) {
+                    const size_t next = nextDestinationIndex++;
+                    const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+                    const Vertex nextDestinationVertex = (next < demandByDestination.size()) ? demandByDestination.vertexAtIndex(next) : noVertex;
+                    worker.runPipelined(destinationVertex, demandByDestination[destinationVertex], nextDestinationVertex);
+                    i = next;
+                }
+            } else {
+                #pragma omp for schedule(guided,1)
+                for (size_t i = 0; i < demandByDestination.size(); i++) {
+                    const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+                    worker.run(destinationVertex, demandByDestination[destinationVertex]);
+                }
+            }
+
+            worker.runCycleRemoval();
+
+            #pragma omp critical
+            {
+                finalize(worker);
+            }
+        }
+        profiler.done();
+    }
+
+    // The result of every destination is stored in resultDirectory together with a hash of the network, the settings
+    // and the demand for the destination. Only destinations without a matching stored result are recomputed, all other
+    // results are loaded. The random generator is seeded for every destination and the results are merged in the order
+    // of the destinations, so the outputs do not depend on which destinations were recomputed or on the number of threads.
+    // Returns the number of recomputed destinations.
+    inline size_t runIncremental(const AccumulatedVertexDemand& demand, const std::string& resultDirectory, const std::string& csaFileName, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        const DemandByDestination demandByDestination = splitDemand(demand);
+        return runIncremental(demandByDestination, resultDirectory, csaFileName, numberOfThreads, pinMultiplier);
+    }
+
+    // Same as above, for demand that has already been split with splitDemand().
+    inline size_t runIncremental(const DemandByDestination& demandByDestination, const std::string& resultDirectory, const std::string& csaFileName, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        profiler.start();
+        clear();
+        const AssignmentStore store(resultDirectory, csaFileName, settings, UseTransferBufferTimes);
+        std::vector<uint64_t> keys(demandByDestination.size());
+        for (size_t i = 0; i < demandByDestination.size(); i++) {
+            keys[i] = store.getKey(demandByDestination[demandByDestination.vertexAtIndex(i)]);
+        }
+
+        const int numCores = numberOfCores();
+        std::atomic<size_t> recomputedDestinations(0);
+        omp_set_num_threads(numberOfThreads);
+        prepareTransfers();
+        #pragma omp parallel
+        {
             int threadId = omp_get_thread_num();
             pinThreadToCoreId((threadId * pinMultiplier) % numCores);
             AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
 
-            WorkerType worker(data, reverseGraph, settings, decisionModel);
+            WorkerType worker(data, reverseGraph, settings, decisionModel, 1, getPATCache(), preparedNetwork, periodicTimetable.get(), accessWalking.get());
+            worker.setTransfers(getTransfers());
 
             #pragma omp for schedule(guided,1)
             for (size_t i = 0; i < demandByDestination.size(); i++) {
                 const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
-                worker.run(destinationVertex, demandByDestination[destinationVertex]);
+                if (store.contains(destinationVertex, keys[i])) continue;
+                worker.setRandomSeed(settings.randomSeed + destinationVertex);
+                // The worker reorders the demand, but the store refers to the demand entries by their original position.
+                std::vector<AccumulatedVertexDemand::Entry> destinationDemand = demandByDestination[destinationVertex];
+                worker.run(destinationVertex, destinationDemand);
+                worker.runCycleRemoval();
+                store.store(destinationVertex, keys[i], demandByDestination[destinationVertex], worker.getAssignmentData(), worker.getRemovedCycleConnections(), worker.getRemovedCycles());
+                worker.clearAssignmentData();
+                recomputedDestinations++;
             }
 
-            worker.runCycleRemoval();
+            #pragma omp critical
+            {
+                profiler += worker.getProfiler();
+            }
+        }
+
+        for (size_t i = 0; i < demandByDestination.size(); i++) {
+            const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+            store.appendTo(destinationVertex, keys[i], demandByDestination[destinationVertex], assignmentData, removedCycleConnections, removedCycles);
+        }
+        assignmentData.addGroupsToConnections();
+        profiler.done();
+        return recomputedDestinations;
+    }
+
+    // Capacity-constrained assignment: After every iteration, the connections whose load exceeds the capacity of their trip
+    // receive an additional PAT penalty (settings.overloadPenalty times the relative overload). Only the destinations with
+    // a group that uses a newly penalized connection are reassigned, the results of all other destinations are kept.
+    // Stops if no connection is overloaded or after settings.capacityIterations reassignments. The random generator is
+    // seeded for every destination. Returns the number of assigned destinations for every iteration.
+    inline std::vector<size_t> runCapacityConstrained(const AccumulatedVertexDemand& demand, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        DemandByDestination demandByDestination = splitDemand(demand);
+        return runCapacityConstrained(demandByDestination, numberOfThreads, pinMultiplier);
+    }
+
+    // Same as above, for demand that has already been split with splitDemand(). The demand entries of every destination
+    // are reordered by the workers.
+    inline std::vector<size_t> runCapacityConstrained(DemandByDestination& demandByDestination, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        profiler.start();
+        clear();
+        std::vector<AssignmentData> resultOfDestination(demandByDestination.size(), AssignmentData(0));
+        std::vector<u_int64_t> removedCycleConnectionsOfDestination(demandByDestination.size(), 0);
+        std::vector<u_int64_t> removedCyclesOfDestination(demandByDestination.size(), 0);
+        std::vector<PerceivedTime> connectionPenalties(data.numberOfConnections(), 0);
+        std::vector<size_t> destinationIndices(demandByDestination.size());
+        std::iota(destinationIndices.begin(), destinationIndices.end(), 0);
+        std::vector<size_t> assignedDestinations;
+
+        const int numCores = numberOfCores();
+        omp_set_num_threads(numberOfThreads);
+        prepareTransfers();
+        while (true) {
+            const bool usePenalties = !assignedDestinations.empty();
+            assignedDestinations.emplace_back(destinationIndices.size());
+            #pragma omp parallel
+            {
+                int threadId = omp_get_thread_num();
+                pinThreadToCoreId((threadId * pinMultiplier) % numCores);
+                AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
+
+                WorkerType worker(data, reverseGraph, settings, decisionModel, 1, getPATCache(), preparedNetwork, periodicTimetable.get(), accessWalking.get());
+                worker.setTransfers(getTransfers());
+                if (usePenalties) worker.setConnectionPenalties(&connectionPenalties);
+
+                #pragma omp for schedule(guided,1)
+                for (size_t j = 0; j < destinationIndices.size(); j++) {
+                    const size_t i = destinationIndices[j];
+                    const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+                    worker.setRandomSeed(settings.randomSeed + destinationVertex);
+                    worker.run(destinationVertex, demandByDestination[destinationVertex]);
+                    worker.runCycleRemoval();
+                    const AssignmentData& workerData = worker.getAssignmentData();
+                    resultOfDestination[i].groups = workerData.groups;
+                    resultOfDestination[i].connectionsPerGroup = workerData.connectionsPerGroup;
+                    resultOfDestination[i].unassignedGroups = workerData.unassignedGroups;
+                    resultOfDestination[i].directWalkingGroups = workerData.directWalkingGroups;
+                    removedCycleConnectionsOfDestination[i] = worker.getRemovedCycleConnections();
+                    removedCyclesOfDestination[i] = worker.getRemovedCycles();
+                    worker.clearAssignmentData();
+                }
+
+                #pragma omp critical
+                {
+                    profiler += worker.getProfiler();
+                }
+            }
+            if (assignedDestinations.size() > size_t(settings.capacityIterations)) break;
+
+            std::vector<double> load(data.numberOfConnections(), 0);
+            for (const AssignmentData& result : resultOfDestination) {
+                for (const GroupData& group : result.groups) {
+                    for (const ConnectionId connection : result.connectionsPerGroup[group.groupId]) {
+                        load[connection] += group.groupSize;
+                    }
+                }
+            }
+            std::vector<bool> isPenalized(data.numberOfConnections(), false);
+            for (const ConnectionId i : data.connectionIds()) {
+                const int tripCapacity = data.tripCapacity(data.connections[i].tripId);
+                if (tripCapacity <= 0) continue;
+                const double capacity = tripCapacity * static_cast<double>(settings.passengerMultiplier);
+                if (load[i] <= capacity) continue;
+                connectionPenalties[i] += settings.overloadPenalty * (load[i] - capacity) / capacity;
+                isPenalized[i] = true;
+            }
+            destinationIndices.clear();
+            for (size_t i = 0; i < resultOfDestination.size(); i++) {
+                for (const std::vector<ConnectionId>& connections : resultOfDestination[i].connectionsPerGroup) {
+                    if (std::none_of(connections.begin(), connections.end(), [&](const ConnectionId connection){return isPenalized[connection];})) continue;
+                    destinationIndices.emplace_back(i);
+                    break;
+                }
+            }
+            if (destinationIndices.empty()) break;
+        }
+
+        for (size_t i = 0; i < resultOfDestination.size(); i++) {
+            assignmentData += resultOfDestination[i];
+            removedCycleConnections += removedCycleConnectionsOfDestination[i];
+            removedCycles += removedCyclesOfDestination[i];
+        }
+        assignmentData.addGroupsToConnections();
+        profiler.done();
+        return assignedDestinations;
+    }
+
+    // Monte Carlo replications: The PATs of every destination are computed once and shared by numberOfReplications
+    // assignments with independent random streams. The result of the first replication is kept as the assignment result,
+    // the connection loads of all replications are aggregated in the load statistics. Since the random streams of the
+    // destinations are independent, the statistics are accumulated per destination and summed up.
+    inline void runReplications(const AccumulatedVertexDemand& demand, const size_t numberOfReplications, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        DemandByDestination demandByDestination = splitDemand(demand);
+        runReplications(demandByDestination, numberOfReplications, numberOfThreads, pinMultiplier);
+    }
+
+    // Same as above, for demand that has already been split with splitDemand(). The demand entries of every destination
+    // are reordered by the workers.
+    inline void runReplications(DemandByDestination& demandByDestination, const size_t numberOfReplications, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        AssertMsg(numberOfReplications > 0, "At least one replication is required!");
+        profiler.start();
+        clear();
+        loadStatistics = LoadStatistics(data.numberOfConnections(), numberOfReplications);
+
+        const int numCores = numberOfCores();
+        omp_set_num_threads(numberOfThreads);
+        prepareTransfers();
+        #pragma omp parallel
+        {
+            int threadId = omp_get_thread_num();
+            pinThreadToCoreId((threadId * pinMultiplier) % numCores);
+            AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
+
+            typename WorkerType::PATComputationType pats(data, reverseGraph);
+            if (preparedNetwork) pats.setStopReverseGraph(&preparedNetwork->stopReverseGraph);
+            pats.setPullFootpaths(settings.footpathRelaxation == PullFootpaths);
+            if (periodicTimetable) pats.setPeriodicTimetable(periodicTimetable.get());
+            if (accessWalking) pats.setAccessWalking(accessWalking.get());
+            pats.setTransfers(getTransfers());
+            WorkerType worker(data, reverseGraph, settings, decisionModel, 0, nullptr, preparedNetwork, periodicTimetable.get(), accessWalking.get());
+            // Result of the first replication
+            AssignmentData result(0);
+            u_int64_t threadRemovedCycleConnections = 0;
+            u_int64_t threadRemovedCycles = 0;
+            // The replications of different destinations use independent random streams, so their load statistics add up.
+            LoadStatistics threadStatistics(data.numberOfConnections(), numberOfReplications);
+            DestinationLoadStatistics destinationStatistics(data.numberOfConnections());
+            const double passengerMultiplier = settings.passengerMultiplier;
+
+            #pragma omp for schedule(guided,1)
+            for (size_t i = 0; i < demandByDestination.size(); i++) {
+                const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+                worker.getProfiler().startPATComputation();
+                if (patCache.isEnabled() && patCache.load(pats, destinationVertex, settings.walkingCosts)) {
+                    worker.getProfiler().patCacheHit();
+                } else {
+                    pats.run(destinationVertex, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+                    if (patCache.isEnabled()) patCache.store(pats, destinationVertex);
+                }
+                worker.getProfiler().donePATComputation();
+                for (size_t r = 0; r < numberOfReplications; r++) {
+                    worker.setRandomSeed(replicationSeed(r, destinationVertex));
+                    worker.run(destinationVertex, demandByDestination[destinationVertex], pats);
+                    worker.runCycleRemoval();
+                    const AssignmentData& workerData = worker.getAssignmentData();
+                    for (const GroupData& group : workerData.groups) {
+                        for (const ConnectionId connection : workerData.connectionsPerGroup[group.groupId]) {
+                            destinationStatistics.addLoad(connection, group.groupSize / passengerMultiplier);
+                        }
+                    }
+                    destinationStatistics.doneReplication();
+                    if (r == 0) {
+                        result.appendGroups(workerData);
+                        threadRemovedCycleConnections += worker.getRemovedCycleConnections();
+                        threadRemovedCycles += worker.getRemovedCycles();
+                    }
+                    worker.clearAssignmentData();
+                }
+                destinationStatistics.moveTo(threadStatistics);
+            }
 
             #pragma omp critical
             {
-                finalize(worker);
+                assignmentData.appendGroups(result);
+                removedCycleConnections += threadRemovedCycleConnections;
+                removedCycles += threadRemovedCycles;
+                profiler += worker.getProfiler();
+                loadStatistics += threadStatistics;
             }
         }
+
+        assignmentData.addGroupsToConnections();
         profiler.done();
     }
 
+    // Runs several assignments whose settings differ only in parameters that do not influence the PATs (e.g. the decision model).
+    // The PATs for each destination are computed once per thread and shared by the workers of all assignments.
+    inline static void runSweep(std::vector<Type>& assignments, const AccumulatedVertexDemand& demand, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        AssertMsg(!assignments.empty(), "No assignments to run!");
+        const Type& first = assignments[0];
+        for (Type& assignment : assignments) {
+            AssertMsg(&assignment.data == &first.data, "Assignments of a sweep have to use the same network!");
+            AssertMsg(assignment.settings.hasSamePATs(first.settings), "Assignments of a sweep have to use the same PAT settings!");
+            AssertMsg(assignment.settings.hasSameDemand(first.settings), "Assignments of a sweep have to use the same demand settings!");
+            assignment.profiler.start();
+            assignment.clear();
+        }
+        DemandByDestination demandByDestination = first.splitDemand(demand);
+
+        const int numCores = numberOfCores();
+        omp_set_num_threads(numberOfThreads);
+        assignments[0].prepareTransfers();
+        #pragma omp parallel
+        {
+            srand(first.settings.randomSeed);
+            int threadId = omp_get_thread_num();
+            pinThreadToCoreId((threadId * pinMultiplier) % numCores);
+            AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
+
+            typename WorkerType::PATComputationType pats(first.data, first.reverseGraph);
+            if (first.preparedNetwork) pats.setStopReverseGraph(&first.preparedNetwork->stopReverseGraph);
+            pats.setPullFootpaths(first.settings.footpathRelaxation == PullFootpaths);
+            if (first.periodicTimetable) pats.setPeriodicTimetable(first.periodicTimetable.get());
+            if (first.accessWalking) pats.setAccessWalking(first.accessWalking.get());
+            pats.setTransfers(first.getTransfers());
+            // The workers reference their own data, so the vector must not reallocate
+            std::vector<WorkerType> workers;
+            workers.reserve(assignments.size());
+            for (const Type& assignment : assignments) {
+                workers.emplace_back(assignment.data, assignment.reverseGraph, assignment.settings, assignment.decisionModel, 0, nullptr, assignment.preparedNetwork, first.periodicTimetable.get(), first.accessWalking.get());
+            }
+
+            #pragma omp for schedule(guided,1)
+            for (size_t i = 0; i < demandByDestination.size(); i++) {
+                const Vertex destinationVertex = demandByDestination.vertexAtIndex(i);
+                workers[0].getProfiler().startPATComputation();
+                if (first.patCache.isEnabled() && first.patCache.load(pats, destinationVertex, first.settings.walkingCosts)) {
+                    workers[0].getProfiler().patCacheHit();
+                } else {
+                    pats.run(destinationVertex, first.settings.maxDelay, first.settings.transferCosts, first.settings.walkingCosts, first.settings.waitingCosts);
+                    if (first.patCache.isEnabled()) first.patCache.store(pats, destinationVertex);
+                }
+                workers[0].getProfiler().donePATComputation();
+                for (WorkerType& worker : workers) {
+                    worker.run(destinationVertex, demandByDestination[destinationVertex], pats);
+                }
+            }
+
+            for (WorkerType& worker : workers) {
+                worker.runCycleRemoval();
+            }
+
+            #pragma omp critical
+            {
+                for (size_t i = 0; i < assignments.size(); i++) {
+                    assignments[i].finalize(workers[i]);
+                }
+            }
+        }
+        for (Type& assignment : assignments) {
+            assignment.profiler.done();
+        }
+    }
+
+    // Assigns several user classes, each with its own settings and demand, on the same network. The work is scheduled over
+    // (destination, PAT settings) groups, such that all classes with the same PAT settings are assigned with the PATs that
+    // are computed once for the group.
+    inline static void runMultiClass(std::vector<Type>& assignments, const std::vector<AccumulatedVertexDemand>& demands, const int numberOfThreads = 1, const int pinMultiplier = 1) noexcept {
+        AssertMsg(!assignments.empty(), "No assignments to run!");
+        AssertMsg(assignments.size() == demands.size(), "Every class needs its own demand!");
+        const Type& first = assignments[0];
+        std::vector<size_t> patClass(assignments.size());
+        std::vector<DemandByDestination> demandByDestination;
+        demandByDestination.reserve(assignments.size());
+        std::vector<size_t> destinationRank(first.data.transferGraph.numVertices(), -1);
+        size_t numberOfDestinations = 0;
+        std::vector<std::tuple<size_t, size_t, size_t, Vertex>> jobs;
+        for (size_t c = 0; c < assignments.size(); c++) {
+            Type& assignment = assignments[c];
+            AssertMsg(&assignment.data == &first.data, "All classes have to use the same network!");
+            assignment.profiler.start();
+            assignment.clear();
+            patClass[c] = c;
+            for (size_t d = 0; d < c; d++) {
+                if (!assignment.settings.hasSamePATs(assignments[d].settings)) continue;
+                patClass[c] = d;
+                break;
+            }
+            demandByDestination.emplace_back(assignment.splitDemand(demands[c]));
+            for (size_t i = 0; i < demandByDestination.back().size(); i++) {
+                const Vertex destinationVertex = demandByDestination.back().vertexAtIndex(i);
+                if (destinationRank[destinationVertex] == size_t(-1)) destinationRank[destinationVertex] = numberOfDestinations++;
+                jobs.emplace_back(destinationRank[destinationVertex], patClass[c], c, destinationVertex);
+            }
+        }
+        std::sort(jobs.begin(), jobs.end());
+        std::vector<size_t> firstJobOfGroup;
+        for (size_t j = 0; j < jobs.size(); j++) {
+            if (j > 0 && std::get<0>(jobs[j]) == std::get<0>(jobs[j - 1]) && std::get<1>(jobs[j]) == std::get<1>(jobs[j - 1])) continue;
+            firstJobOfGroup.emplace_back(j);
+        }
+        const size_t numberOfGroups = firstJobOfGroup.size();
+        firstJobOfGroup.emplace_back(jobs.size());
+
+        const int numCores = numberOfCores();
+        omp_set_num_threads(numberOfThreads);
+        for (size_t c = 0; c < assignments.size(); c++) {
+            if (patClass[c] != c) continue;
+            for (size_t d = 0; d < c; d++) {
+                if (patClass[d] != d) continue;
+                assignments[c].shareTransfers(assignments[d]);
+            }
+            assignments[c].prepareTransfers();
+        }
+        #pragma omp parallel
+        {
+            srand(first.settings.randomSeed);
+            int threadId = omp_get_thread_num();
+            pinThreadToCoreId((threadId * pinMultiplier) % numCores);
+            AssertMsg(omp_get_num_threads() == numberOfThreads, "Number of threads is " << omp_get_num_threads() << ", but should be " << numberOfThreads << "!");
+
+            typename WorkerType::PATComputationType pats(first.data, first.reverseGraph);
+            if (first.preparedNetwork) pats.setStopReverseGraph(&first.preparedNetwork->stopReverseGraph);
+            pats.setPullFootpaths(first.settings.footpathRelaxation == PullFootpaths);
+            // The workers reference their own data, so the vector must not reallocate. Classes with the same PAT settings
+            // share the periodic timetable of the class that owns the PATs.
+            std::vector<WorkerType> workers;
+            workers.reserve(assignments.size());
+            for (size_t c = 0; c < assignments.size(); c++) {
+                const Type& assignment = assignments[c];
+                workers.emplace_back(assignment.data, assignment.reverseGraph, assignment.settings, assignment.decisionModel, 0, nullptr, assignment.preparedNetwork, assignments[patClass[c]].periodicTimetable.get(), assignments[patClass[c]].accessWalking.get());
+            }
+
+            #pragma omp for schedule(dynamic,1)
+            for (size_t g = 0; g < numberOfGroups; g++) {
+                const size_t patOwner = std::get<1>(jobs[firstJobOfGroup[g]]);
+                const size_t firstClass = std::get<2>(jobs[firstJobOfGroup[g]]);
+                const Vertex destinationVertex = std::get<3>(jobs[firstJobOfGroup[g]]);
+                const Type& owner = assignments[patOwner];
+                if (pats.getPeriodicTimetable() != owner.periodicTimetable.get()) pats.setPeriodicTimetable(owner.periodicTimetable.get());
+                if (pats.getAccessWalking() != owner.accessWalking.get()) pats.setAccessWalking(owner.accessWalking.get());
+                pats.setTransfers(owner.getTransfers());
+                workers[firstClass].getProfiler().startPATComputation();
+                if (owner.patCache.isEnabled() && owner.patCache.load(pats, destinationVertex, owner.settings.walkingCosts)) {
+                    workers[firstClass].getProfiler().patCacheHit();
+                } else {
+                    pats.run(destinationVertex, owner.settings.maxDelay, owner.settings.transferCosts, owner.settings.walkingCosts, owner.settings.waitingCosts);
+                    if (owner.patCache.isEnabled()) owner.patCache.store(pats, destinationVertex);
+                }
+                workers[firstClass].getProfiler().donePATComputation();
+                for (size_t j = firstJobOfGroup[g]; j < firstJobOfGroup[g + 1]; j++) {
+                    const size_t c = std::get<2>(jobs[j]);
+                    workers[c].run(destinationVertex, demandByDestination[c][destinationVertex], pats);
+                }
+            }
+
+            for (WorkerType& worker : workers) {
+                worker.runCycleRemoval();
+            }
+
+            #pragma omp critical
+            {
+                for (size_t c = 0; c < assignments.size(); c++) {
+                    assignments[c].finalize(workers[c]);
+                }
+            }
+        }
+        for (Type& assignment : assignments) {
+            assignment.profiler.done();
+        }
+    }
+
     inline const AssignmentData& getAssignmentData() const noexcept {
         return assignmentData;
     }
@@ -115,11 +604,48 @@ public:
         return passengerCounts;
     }
 
+    inline const LoadStatistics& getLoadStatistics() const noexcept {
+        return loadStatistics;
+    }
+
+    // After runReplications(), the file additionally contains the mean load over all replications, its standard deviation
+    // and the bounds of the 95% confidence interval for the mean.
     inline void writeConnectionsWithLoad(const std::string& fileName) const noexcept {
+        const bool withStatistics = loadStatistics.getNumberOfReplications() > 1;
         IO::OFStream file(fileName);
-        file << CSA::Connection::CSV_HEADER << ",connectionId,load\n";
+        file << CSA::Connection::CSV_HEADER << ",connectionId,load";
+        if (withStatistics) file << ",meanLoad,loadStdDev,meanLoadLower,meanLoadUpper";
+        file << "\n";
         for (const ConnectionId i : data.connectionIds()) {
-            data.connections[i].toCSV(file) << "," << i.value() << "," << getPassengerCountForConnection(i) << "\n";
+            data.connections[i].toCSV(file) << "," << i.value() << "," << getPassengerCountForConnection(i);
+            if (withStatistics) {
+                const double mean = loadStatistics.getMean(i);
+                const double radius = loadStatistics.getConfidenceRadius(i);
+                file << "," << mean << "," << loadStatistics.getStandardDeviation(i) << "," << std::max(0.0, mean - radius) << "," << (mean + radius);
+            }
+            file << "\n";
+        }
+    }
+
+    // Combined loads of several assignments on the same network (e.g. the classes of a multi-class assignment).
+    inline static void writeConnectionsWithLoad(const std::vector<Type>& assignments, const std::string& fileName) noexcept {
+        AssertMsg(!assignments.empty(), "No assignments to write!");
+        const CSA::Data& data = assignments[0].data;
+        IO::OFStream file(fileName);
+        file << CSA::Connection::CSV_HEADER << ",connectionId";
+        for (size_t i = 0; i < assignments.size(); i++) {
+            file << ",load_" << i;
+        }
+        file << ",load\n";
+        for (const ConnectionId i : data.connectionIds()) {
+            data.connections[i].toCSV(file) << "," << i.value();
+            double load = 0;
+            for (const Type& assignment : assignments) {
+                const double classLoad = assignment.getPassengerCountForConnection(i);
+                file << "," << classLoad;
+                load += classLoad;
+            }
+            file << "," << load << "\n";
         }
     }
 
@@ -132,7 +658,7 @@ public:
     }
 
     inline void writeAssignedJourneys(const std::string& fileName, const AccumulatedVertexDemand& demand) const noexcept {
-        JourneyWriter journeyWriter(data, settings, demand, assignmentData);
+        JourneyWriter journeyWriter(data, settings, demand, assignmentData, accessWalking.get());
         journeyWriter.write(fileName);
     }
 
@@ -215,7 +741,37 @@ public:
     }
 
 private:
+    inline const PATCache* getPATCache() const noexcept {
+        return patCache.isEnabled() ? &patCache : nullptr;
+    }
+
+    // The transfers between trips (only used by TripBasedPATs) do not depend on the destination, so they are computed once
+    // before the workers are started and shared by all PAT computations.
+    inline void prepareTransfers() noexcept {
+        if constexpr (WorkerType::PATComputationType::UsesTripTransfers) {
+            if (transfers && transfers->isCompatible(settings.maxDelay, UseTransferBufferTimes)) return;
+            transfers = std::make_shared<const TripTransfers>(data, settings.maxDelay, UseTransferBufferTimes);
+        }
+    }
+
+    inline void shareTransfers(const Type& other) noexcept {
+        if (transfers && transfers->isCompatible(settings.maxDelay, UseTransferBufferTimes)) return;
+        if (other.transfers && other.transfers->isCompatible(settings.maxDelay, UseTransferBufferTimes)) transfers = other.transfers;
+    }
+
+    inline const TripTransfers* getTransfers() const noexcept {
+        return transfers.get();
+    }
+
+    inline int replicationSeed(const size_t replication, const Vertex destinationVertex) const noexcept {
+        std::seed_seq sequence{size_t(settings.randomSeed), replication, size_t(destinationVertex.value())};
+        std::vector<uint32_t> seed(1);
+        sequence.generate(seed.begin(), seed.end());
+        return seed[0];
+    }
+
     inline void clear() noexcept {
+        loadStatistics = LoadStatistics();
         assignmentData.clear();
         removedCycleConnections = 0;
         removedCycles = 0;
@@ -239,9 +795,16 @@ private:
     AssignmentData assignmentData;
     u_int64_t removedCycleConnections;
     u_int64_t removedCycles;
+    LoadStatistics loadStatistics;
 
     Profiler profiler;
 
+    PATCache patCache;
+    const PreparedNetwork* preparedNetwork;
+    std::unique_ptr<CSA::PeriodicTimetable> periodicTimetable;
+    std::unique_ptr<AccessWalking> accessWalking;
+    std::shared_ptr<const TripTransfers> transfers;
+
 };
 
 }
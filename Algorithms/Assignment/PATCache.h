@@ -0,0 +1,74 @@
+#pragma once
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "../../DataStructures/Assignment/Settings.h"
+
+#include "../../Helpers/Hash.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/FileSystem/FileSystem.h"
+
+namespace Assignment {
+
+// Stores the PATs of every destination in a separate file within <directory>/<key>, where the key is a hash of the
+// network files and of all settings that influence the PATs. Later runs with the same key load the PATs instead of
+// recomputing them. The files use the compressed, memory-mapped format of PATFile.
+class PATCache {
+
+private:
+    inline static constexpr size_t Version = 2;
+
+public:
+    PATCache() : enabled(false) {}
+    PATCache(const std::string& directory, const std::string& csaFileName, const Settings& settings, const bool useTransferBufferTimes) :
+        enabled(true) {
+        std::stringstream settingsString;
+        settingsString << std::setprecision(17) << Version << "," << settings.transferCosts << "," << settings.walkingCosts << "," << settings.waitingCosts << "," << settings.maxDelay << "," << useTransferBufferTimes;
+        if (settings.periodicTimetable) settingsString << ",periodic," << settings.periodicHorizon;
+        if (settings.chAccessWalking) settingsString << ",chAccess," << settings.maxAccessWalkingTime;
+        const uint64_t key = Hash::string(settingsString.str(), Hash::csaBinary(csaFileName));
+        cacheDirectory = FileSystem::extendPath(directory, Hash::toString(key));
+        FileSystem::makeDirectory(cacheDirectory);
+    }
+
+    inline bool isEnabled() const noexcept {
+        return enabled;
+    }
+
+    inline const std::string& getDirectory() const noexcept {
+        return cacheDirectory;
+    }
+
+    template<typename PAT_COMPUTATION>
+    inline bool load(PAT_COMPUTATION& pats, const Vertex destination, const double walkingCosts) const noexcept {
+        const std::string fileName = getFileName(destination);
+        if (!FileSystem::isFile(fileName)) return false;
+        pats.readBinary(fileName, destination, walkingCosts);
+        return true;
+    }
+
+    // The file is written under a temporary name first, such that concurrent runs never read incomplete files.
+    template<typename PAT_COMPUTATION>
+    inline void store(const PAT_COMPUTATION& pats, const Vertex destination) const noexcept {
+        const std::string fileName = getFileName(destination);
+        const std::string temporaryFileName = fileName + ".tmp" + std::to_string(getpid());
+        pats.writeBinary(temporaryFileName);
+        if (!FileSystem::renameFile(temporaryFileName, fileName)) FileSystem::deleteFile(temporaryFileName);
+    }
+
+private:
+    inline std::string getFileName(const Vertex destination) const noexcept {
+        return FileSystem::extendPath(cacheDirectory, std::to_string(destination.value()) + ".pats");
+    }
+
+private:
+    bool enabled;
+    std::string cacheDirectory;
+
+};
+
+}
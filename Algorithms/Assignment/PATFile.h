@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../DataStructures/Assignment/Profile.h"
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/IO/MappedFile.h"
+
+namespace Assignment {
+
+// Compressed file format of the PATs for one destination, which is accessed through a read-only memory mapping. The file
+// consists of a header followed by 64 byte aligned sections: The labels of all reached connections as one stream, the
+// byte offset of the waiting profile of every stop, and the waiting profiles. Connection ids, departure times and
+// connection ids of profile entries are delta-encoded as variable length integers, and so are the PATs, which are mostly
+// integral, relative to the previous PAT of the same kind. Every profile is encoded independently, so it can be decoded
+// without the others.
+class PATFile {
+
+public:
+    inline static constexpr char Magic[8] = {'P', 'A', 'T', 'F', 'I', 'L', 'E', '\0'};
+    inline static constexpr uint64_t Version = 1;
+    inline static constexpr size_t Alignment = 64;
+    // Integral PATs below this bound are exactly representable as integers
+    inline static constexpr PerceivedTime MaxIntegralPAT = 4503599627370496.0;
+
+    enum Section : uint8_t {
+        ConnectionLabels,
+        ProfileBegin,
+        Profiles,
+        NumberOfSections
+    };
+
+    struct Header {
+        char magic[8];
+        uint64_t version;
+        uint64_t target;
+        uint64_t numberOfConnections;
+        uint64_t numberOfStops;
+        uint64_t numberOfReachedConnections;
+        uint64_t offset[NumberOfSections];
+        uint64_t size[NumberOfSections];
+    };
+
+public:
+    PATFile(const std::string& fileName) :
+        file(fileName),
+        header(file.isOpen() && file.size() >= sizeof(Header) ? file.at<Header>(0) : nullptr) {
+        Ensure(header, "Cannot map the file " << fileName << "!");
+        Ensure(std::memcmp(header->magic, Magic, sizeof(Magic)) == 0, "The file " << fileName << " is not a PAT file!");
+        Ensure(header->version == Version, "The file " << fileName << " has version " << header->version << ", but version " << Version << " is required!");
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            Ensure(header->offset[section] + header->size[section] <= file.size(), "The file " << fileName << " is truncated!");
+        }
+        Ensure(header->size[ProfileBegin] == (header->numberOfStops + 1) * sizeof(uint64_t), "The file " << fileName << " is corrupted!");
+    }
+
+    // CONNECTION_LABEL has the members tripPAT, transferPAT and skipPAT, getProfile(stop) returns the waiting profile.
+    template<typename CONNECTION_LABEL, typename GET_PROFILE>
+    inline static void Write(const std::string& fileName, const Vertex target, const std::vector<CONNECTION_LABEL>& connectionLabels, const size_t numberOfStops, const GET_PROFILE& getProfile) noexcept {
+        Header header;
+        std::memset(&header, 0, sizeof(Header));
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.target = target.value();
+        header.numberOfConnections = connectionLabels.size();
+        header.numberOfStops = numberOfStops;
+
+        std::vector<uint8_t> labels;
+        size_t previousConnection = -1;
+        PerceivedTime previousPAT[3] = {0, 0, 0};
+        for (size_t i = 0; i < connectionLabels.size(); i++) {
+            const CONNECTION_LABEL& label = connectionLabels[i];
+            if ((label.tripPAT == Unreachable) && (label.transferPAT == Unreachable) && (label.skipPAT == Unreachable)) continue;
+            writeVarint(labels, i - previousConnection - 1);
+            writePAT(labels, label.tripPAT, previousPAT[0]);
+            writePAT(labels, label.transferPAT, previousPAT[1]);
+            writePAT(labels, label.skipPAT, previousPAT[2]);
+            previousConnection = i;
+            header.numberOfReachedConnections++;
+        }
+
+        std::vector<uint64_t> profileBegin(1, 0);
+        std::vector<uint8_t> profiles;
+        for (size_t stop = 0; stop < numberOfStops; stop++) {
+            int64_t previousDepartureTime = 0;
+            int64_t previousConnectionId = 0;
+            PerceivedTime previousNormalizedPAT = 0;
+            for (const ProfileEntry& entry : getProfile(StopId(stop))) {
+                writeVarint(profiles, zigzag(int64_t(entry.departureTime) - previousDepartureTime));
+                writeVarint(profiles, zigzag(int64_t(entry.connectionId.value()) - previousConnectionId));
+                writePAT(profiles, entry.getNormalizedPAT(), previousNormalizedPAT);
+                previousDepartureTime = entry.departureTime;
+                previousConnectionId = entry.connectionId.value();
+            }
+            profileBegin.emplace_back(profiles.size());
+        }
+
+        const std::pair<const void*, size_t> sections[NumberOfSections] = {
+            bytesOf(labels),
+            bytesOf(profileBegin),
+            bytesOf(profiles)
+        };
+        uint64_t offset = align(sizeof(Header));
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            header.offset[section] = offset;
+            header.size[section] = sections[section].second;
+            offset = align(offset + sections[section].second);
+        }
+
+        std::ofstream out(fileName, std::ios::binary);
+        Ensure(out, "Cannot create the file " << fileName << "!");
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        size_t position = sizeof(Header);
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            const std::vector<char> padding(header.offset[section] - position, 0);
+            out.write(padding.data(), padding.size());
+            out.write(static_cast<const char*>(sections[section].first), sections[section].second);
+            position = header.offset[section] + header.size[section];
+        }
+    }
+
+    inline Vertex target() const noexcept {return Vertex(header->target);}
+    inline size_t numberOfConnections() const noexcept {return header->numberOfConnections;}
+    inline size_t numberOfStops() const noexcept {return header->numberOfStops;}
+    inline size_t numberOfReachedConnections() const noexcept {return header->numberOfReachedConnections;}
+
+    // Labels of connections that are not stored are reset to the default label.
+    template<typename CONNECTION_LABEL>
+    inline void readConnectionLabels(std::vector<CONNECTION_LABEL>& connectionLabels) const noexcept {
+        Ensure(connectionLabels.size() == numberOfConnections(), "The PATs have been computed for a different network!");
+        std::fill(connectionLabels.begin(), connectionLabels.end(), CONNECTION_LABEL());
+        const uint8_t* position = section<uint8_t>(ConnectionLabels);
+        const uint8_t* end = position + header->size[ConnectionLabels];
+        size_t connection = -1;
+        PerceivedTime previousPAT[3] = {0, 0, 0};
+        for (size_t i = 0; i < numberOfReachedConnections(); i++) {
+            connection += readVarint(position) + 1;
+            Ensure(connection < connectionLabels.size(), "Connection " << connection << " does not exist!");
+            CONNECTION_LABEL& label = connectionLabels[connection];
+            label.tripPAT = readPAT(position, previousPAT[0]);
+            label.transferPAT = readPAT(position, previousPAT[1]);
+            label.skipPAT = readPAT(position, previousPAT[2]);
+        }
+        Ensure(position == end, "The connection labels are corrupted!");
+    }
+
+    inline void readProfile(const StopId stop, Profile& profile) const noexcept {
+        AssertMsg(stop < numberOfStops(), "Stop " << stop << " does not exist!");
+        profile.clear();
+        const uint64_t* profileBegin = section<uint64_t>(ProfileBegin);
+        const uint8_t* position = section<uint8_t>(Profiles) + profileBegin[stop];
+        const uint8_t* end = section<uint8_t>(Profiles) + profileBegin[size_t(stop) + 1];
+        int64_t departureTime = 0;
+        int64_t connectionId = 0;
+        PerceivedTime previousNormalizedPAT = 0;
+        while (position < end) {
+            departureTime += unzigzag(readVarint(position));
+            connectionId += unzigzag(readVarint(position));
+            const PerceivedTime normalizedPAT = readPAT(position, previousNormalizedPAT);
+            profile.emplace_back(ProfileEntry::FromNormalizedPAT(departureTime, ConnectionId(uint32_t(connectionId)), normalizedPAT));
+        }
+        Ensure(position == end, "The profile of stop " << stop << " is corrupted!");
+    }
+
+private:
+    template<typename T>
+    inline static std::pair<const void*, size_t> bytesOf(const std::vector<T>& vector) noexcept {
+        return std::make_pair(static_cast<const void*>(vector.data()), vector.size() * sizeof(T));
+    }
+
+    inline static uint64_t align(const uint64_t offset) noexcept {
+        return ((offset + Alignment - 1) / Alignment) * Alignment;
+    }
+
+    template<typename T>
+    inline const T* section(const Section section) const noexcept {
+        return file.at<T>(header->offset[section]);
+    }
+
+    inline static uint64_t zigzag(const int64_t value) noexcept {
+        return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    }
+
+    inline static int64_t unzigzag(const uint64_t value) noexcept {
+        return int64_t(value >> 1) ^ -int64_t(value & 1);
+    }
+
+    inline static void writeVarint(std::vector<uint8_t>& bytes, uint64_t value) noexcept {
+        while (value >= 0x80) {
+            bytes.emplace_back(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        bytes.emplace_back(uint8_t(value));
+    }
+
+    inline static uint64_t readVarint(const uint8_t*& position) noexcept {
+        uint64_t value = 0;
+        for (size_t shift = 0; true; shift += 7) {
+            const uint8_t byte = *(position++);
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+
+    inline static bool isIntegral(const PerceivedTime pat) noexcept {
+        return std::abs(pat) < MaxIntegralPAT && pat == std::trunc(pat);
+    }
+
+    // Integral PATs (the common case) are stored as the zigzag encoded difference to the previous PAT, shifted by one bit.
+    // Otherwise, the lowest bit is set, and a control byte with the number of leading (low nibble) and trailing (high
+    // nibble) zero bytes of the XOR with the previous PAT is followed by the remaining bytes.
+    inline static void writePAT(std::vector<uint8_t>& bytes, const PerceivedTime pat, PerceivedTime& previous) noexcept {
+        if (isIntegral(pat) && isIntegral(previous)) {
+            writeVarint(bytes, zigzag(int64_t(pat) - int64_t(previous)) << 1);
+            previous = pat;
+            return;
+        }
+        writeVarint(bytes, 1);
+        const uint64_t difference = bitsOf(pat) ^ bitsOf(previous);
+        previous = pat;
+        if (difference == 0) {
+            bytes.emplace_back(8);
+            return;
+        }
+        const int leadingBytes = __builtin_clzll(difference) / 8;
+        const int trailingBytes = __builtin_ctzll(difference) / 8;
+        bytes.emplace_back(uint8_t(leadingBytes | (trailingBytes << 4)));
+        for (int byte = trailingBytes; byte < 8 - leadingBytes; byte++) {
+            bytes.emplace_back(uint8_t(difference >> (8 * byte)));
+        }
+    }
+
+    inline static PerceivedTime readPAT(const uint8_t*& position, PerceivedTime& previous) noexcept {
+        const uint64_t value = readVarint(position);
+        if ((value & 1) == 0) {
+            previous = PerceivedTime(int64_t(previous) + unzigzag(value >> 1));
+            return previous;
+        }
+        const uint8_t control = *(position++);
+        const int leadingBytes = control & 0x0F;
+        const int trailingBytes = control >> 4;
+        uint64_t difference = 0;
+        for (int byte = trailingBytes; byte < 8 - leadingBytes; byte++) {
+            difference |= uint64_t(*(position++)) << (8 * byte);
+        }
+        const uint64_t bits = bitsOf(previous) ^ difference;
+        std::memcpy(&previous, &bits, sizeof(bits));
+        return previous;
+    }
+
+    inline static uint64_t bitsOf(const PerceivedTime pat) noexcept {
+        uint64_t bits;
+        std::memcpy(&bits, &pat, sizeof(bits));
+        return bits;
+    }
+
+private:
+    IO::MappedFile file;
+    const Header* header;
+
+};
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Graph/Graph.h"
+
+#include "../../Helpers/Types.h"
+#include "../../Helpers/IO/Serialization.h"
+
+#include "CycleRemoval.h"
+
+namespace Assignment {
+
+// Network data that does not depend on the destination and would otherwise be derived again by every worker.
+struct PreparedNetwork {
+    PreparedNetwork() {}
+    PreparedNetwork(const CSA::Data& data, const CSA::TransferGraph& reverseGraph) :
+        stationByStop(CycleRemoval::computeStationByStop(data)) {
+        Intermediate::TransferGraph graph;
+        graph.addVertices(data.numberOfStops());
+        for (const StopId stop : data.stops()) {
+            graph.set(Coordinates, stop, reverseGraph.get(Coordinates, stop));
+            for (const Edge edge : reverseGraph.edgesFrom(stop)) {
+                const Vertex from = reverseGraph.get(ToVertex, edge);
+                if (!data.isStop(from)) continue;
+                graph.addEdge(stop, from).set(TravelTime, reverseGraph.get(TravelTime, edge));
+            }
+        }
+        graph.packEdges();
+        Graph::move(std::move(graph), stopReverseGraph);
+    }
+
+    inline static PreparedNetwork FromBinary(const std::string& fileName) noexcept {
+        PreparedNetwork result;
+        result.deserialize(fileName);
+        return result;
+    }
+
+    inline void serialize(const std::string& fileName) const noexcept {
+        IO::serialize(fileName, stationByStop);
+        stopReverseGraph.writeBinary(fileName + ".graph");
+    }
+
+    inline void deserialize(const std::string& fileName) noexcept {
+        IO::deserialize(fileName, stationByStop);
+        stopReverseGraph.readBinary(fileName + ".graph");
+    }
+
+    std::vector<StopId> stationByStop;
+    // Reverse transfer graph restricted to edges between stops, which are the only edges relaxed by the PAT computation.
+    CSA::TransferGraph stopReverseGraph;
+};
+
+}
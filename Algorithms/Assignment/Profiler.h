@@ -118,6 +118,7 @@ public:
 
     inline void startPATComputation() const noexcept {}
     inline void donePATComputation() const noexcept {}
+    inline void patCacheHit() const noexcept {}
 
     inline void startAssignment() const noexcept {}
     inline void doneAssignment() const noexcept {}
@@ -165,6 +166,7 @@ public:
     inline void initialize() noexcept {
         numberOfCalculations = 0;
         numberOfPATComputations = 0;
+        numberOfPATCacheHits = 0;
         timeForEverything = 0;
         timeForPATComputation = 0;
         timeForAssignment = 0;
@@ -191,6 +193,9 @@ public:
     inline void donePATComputation() noexcept {
         timeForPATComputation += timerForPATComputation.elapsedMicroseconds();
     }
+    inline void patCacheHit() noexcept {
+        numberOfPATCacheHits++;
+    }
 
     inline void startAssignment() noexcept {
         timerForAssignment.restart();
@@ -243,11 +248,13 @@ public:
         std::cout << "Cycle removal:   " << String::musToString(getCycleEliminationTime()) << std::endl;
         std::cout << "Total time:      " << String::musToString(getTotalTime()) << std::endl;
         std::cout << "#Targets:        " << String::prettyInt(numberOfPATComputations) << std::endl;
+        std::cout << "#PAT cache hits: " << String::prettyInt(numberOfPATCacheHits) << std::endl;
         std::cout << "#Paths:          " << String::prettyDouble(pathsPerPassenger) << std::endl;
     }
 
     inline TimeProfiler& operator+=(const TimeProfiler& other) noexcept {
         numberOfPATComputations += other.numberOfPATComputations;
+        numberOfPATCacheHits += other.numberOfPATCacheHits;
         timeForPATComputation += other.timeForPATComputation;
         timeForAssignment += other.timeForAssignment;
         timeForInitialWalking += other.timeForInitialWalking;
@@ -258,6 +265,7 @@ public:
 private:
     int numberOfCalculations;
     int numberOfPATComputations;
+    int numberOfPATCacheHits;
 
     Timer timerForEverything;
     Timer timerForPATComputation;
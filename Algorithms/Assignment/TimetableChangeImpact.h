@@ -0,0 +1,219 @@
+#pragma once
+
+#include <tuple>
+#include <vector>
+
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
+
+#include "../../Helpers/Types.h"
+
+#include "AssignmentStore.h"
+
+namespace Assignment {
+
+// Compares two versions of a timetable with identical stops and transfer graph. Trips are matched if they consist of the
+// same sequence of connections, all connections of unmatched trips are considered as changed. The PATs (and therefore the
+// assignment) for a destination can only be affected by a change if the destination can be reached from a changed
+// connection in the old or in the new timetable. This is checked with a forward earliest arrival scan that starts at the
+// arrival of every changed connection and ignores minimum transfer times, which yields a conservative bound.
+// Both timetables have to be sorted by departure time. For periodic timetables, the scan includes the copies of the
+// connections on the next day (see CSA::PeriodicTimetable), such that changes affect journeys across midnight.
+class TimetableChangeImpact {
+
+private:
+    using TripKey = std::vector<std::tuple<StopId, StopId, int, int>>;
+
+public:
+    TimetableChangeImpact(const CSA::Data& oldData, const CSA::Data& newData, const bool periodic = false, const int periodicHorizon = 24 * 60 * 60) :
+        oldData(oldData),
+        newData(newData),
+        periodic(periodic),
+        periodicHorizon(periodicHorizon),
+        sameTransferGraph(haveSameTransferGraph()),
+        newConnectionOfOld(oldData.numberOfConnections(), noConnection),
+        oldConnectionOfNew(newData.numberOfConnections(), noConnection),
+        numberOfChangedOldTrips(0),
+        numberOfChangedNewTrips(0),
+        numberOfChangedOldConnections(0),
+        numberOfChangedNewConnections(0),
+        isAffectedVertex(newData.transferGraph.numVertices(), !sameTransferGraph) {
+        if (!sameTransferGraph) return;
+        matchTrips();
+        markAffectedVertices(oldData, newConnectionOfOld);
+        markAffectedVertices(newData, oldConnectionOfNew);
+    }
+
+    // If the transfer graphs differ, all destinations are affected.
+    inline bool hasSameTransferGraph() const noexcept {
+        return sameTransferGraph;
+    }
+
+    inline bool isAffected(const Vertex destination) const noexcept {
+        return isAffectedVertex[destination];
+    }
+
+    // noConnection for connections that have been removed or changed.
+    inline const std::vector<ConnectionId>& getNewConnectionOfOld() const noexcept {
+        return newConnectionOfOld;
+    }
+
+    inline size_t getNumberOfChangedOldTrips() const noexcept {
+        return numberOfChangedOldTrips;
+    }
+
+    inline size_t getNumberOfChangedNewTrips() const noexcept {
+        return numberOfChangedNewTrips;
+    }
+
+    inline size_t getNumberOfChangedOldConnections() const noexcept {
+        return numberOfChangedOldConnections;
+    }
+
+    inline size_t getNumberOfChangedNewConnections() const noexcept {
+        return numberOfChangedNewConnections;
+    }
+
+    // Copies the results of all unaffected destinations from oldStore to newStore. Returns the number of migrated
+    // destinations, all other destinations have to be recomputed.
+    template<typename SPLIT_DEMAND>
+    inline size_t migrate(const SPLIT_DEMAND& demandByDestination, const AssignmentStore& oldStore, const AssignmentStore& newStore) const noexcept {
+        size_t migratedDestinations = 0;
+        for (size_t i = 0; i < demandByDestination.size(); i++) {
+            const Vertex destination = demandByDestination.vertexAtIndex(i);
+            if (isAffected(destination)) continue;
+            const uint64_t newKey = newStore.getKey(demandByDestination[destination]);
+            if (newStore.contains(destination, newKey)) {
+                migratedDestinations++;
+                continue;
+            }
+            const uint64_t oldKey = oldStore.getKey(demandByDestination[destination]);
+            if (newStore.migrateFrom(oldStore, destination, oldKey, newKey, newConnectionOfOld)) migratedDestinations++;
+        }
+        return migratedDestinations;
+    }
+
+private:
+    inline bool haveSameTransferGraph() const noexcept {
+        if (oldData.numberOfStops() != newData.numberOfStops()) return false;
+        if (oldData.transferGraph.numVertices() != newData.transferGraph.numVertices()) return false;
+        if (oldData.transferGraph.numEdges() != newData.transferGraph.numEdges()) return false;
+        for (const Vertex vertex : oldData.transferGraph.vertices()) {
+            if (oldData.transferGraph.outDegree(vertex) != newData.transferGraph.outDegree(vertex)) return false;
+            std::vector<std::pair<Vertex, int>> oldEdges;
+            for (const Edge edge : oldData.transferGraph.edgesFrom(vertex)) {
+                oldEdges.emplace_back(oldData.transferGraph.get(ToVertex, edge), oldData.transferGraph.get(TravelTime, edge));
+            }
+            std::vector<std::pair<Vertex, int>> newEdges;
+            for (const Edge edge : newData.transferGraph.edgesFrom(vertex)) {
+                newEdges.emplace_back(newData.transferGraph.get(ToVertex, edge), newData.transferGraph.get(TravelTime, edge));
+            }
+            std::sort(oldEdges.begin(), oldEdges.end());
+            std::sort(newEdges.begin(), newEdges.end());
+            if (oldEdges != newEdges) return false;
+        }
+        return true;
+    }
+
+    inline static std::vector<std::vector<ConnectionId>> connectionsByTrip(const CSA::Data& data) noexcept {
+        std::vector<std::vector<ConnectionId>> result(data.numberOfTrips());
+        for (const ConnectionId i : data.connectionIds()) {
+            result[data.connections[i].tripId].emplace_back(i);
+        }
+        return result;
+    }
+
+    inline static TripKey getTripKey(const CSA::Data& data, const std::vector<ConnectionId>& tripConnections) noexcept {
+        TripKey key;
+        for (const ConnectionId i : tripConnections) {
+            const CSA::Connection& connection = data.connections[i];
+            key.emplace_back(connection.departureStopId, connection.arrivalStopId, connection.departureTime, connection.arrivalTime);
+        }
+        return key;
+    }
+
+    inline void matchTrips() noexcept {
+        const std::vector<std::vector<ConnectionId>> oldConnectionsByTrip = connectionsByTrip(oldData);
+        const std::vector<std::vector<ConnectionId>> newConnectionsByTrip = connectionsByTrip(newData);
+        Map<TripKey, std::vector<TripId>> oldTripsByKey;
+        for (const TripId trip : oldData.tripIds()) {
+            if (oldConnectionsByTrip[trip].empty()) continue;
+            oldTripsByKey[getTripKey(oldData, oldConnectionsByTrip[trip])].emplace_back(trip);
+        }
+        for (const TripId newTrip : newData.tripIds()) {
+            if (newConnectionsByTrip[newTrip].empty()) continue;
+            const TripKey key = getTripKey(newData, newConnectionsByTrip[newTrip]);
+            if (!oldTripsByKey.contains(key) || oldTripsByKey[key].empty()) {
+                numberOfChangedNewTrips++;
+                numberOfChangedNewConnections += newConnectionsByTrip[newTrip].size();
+                continue;
+            }
+            const TripId oldTrip = oldTripsByKey[key].back();
+            oldTripsByKey[key].pop_back();
+            for (size_t i = 0; i < newConnectionsByTrip[newTrip].size(); i++) {
+                newConnectionOfOld[oldConnectionsByTrip[oldTrip][i]] = newConnectionsByTrip[newTrip][i];
+                oldConnectionOfNew[newConnectionsByTrip[newTrip][i]] = oldConnectionsByTrip[oldTrip][i];
+            }
+        }
+        for (const auto& [key, trips] : oldTripsByKey) {
+            numberOfChangedOldTrips += trips.size();
+            numberOfChangedOldConnections += trips.size() * key.size();
+        }
+    }
+
+    // Marks all vertices that can be reached from a changed connection of data (i.e., a connection without counterpart).
+    inline void markAffectedVertices(const CSA::Data& data, const std::vector<ConnectionId>& counterpart) noexcept {
+        std::vector<int> arrivalTime(data.numberOfStops(), INFTY);
+        if (periodic) {
+            const CSA::PeriodicTimetable timetable(data, 24 * 60 * 60, periodicHorizon);
+            std::vector<bool> tripReached(timetable.numberOfTrips(), false);
+            for (const ConnectionId i : timetable.scanOrder()) {
+                scanConnection(data, timetable.connection(i), counterpart[timetable.originalConnection(i)] == noConnection, arrivalTime, tripReached);
+            }
+        } else {
+            std::vector<bool> tripReached(data.numberOfTrips(), false);
+            for (const ConnectionId i : data.connectionIds()) {
+                scanConnection(data, data.connections[i], counterpart[i] == noConnection, arrivalTime, tripReached);
+            }
+        }
+        for (const StopId stop : data.stops()) {
+            if (arrivalTime[stop] == INFTY) continue;
+            isAffectedVertex[stop] = true;
+            for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                isAffectedVertex[data.transferGraph.get(ToVertex, edge)] = true;
+            }
+        }
+    }
+
+    inline static void scanConnection(const CSA::Data& data, const CSA::Connection& connection, const bool changed, std::vector<int>& arrivalTime, std::vector<bool>& tripReached) noexcept {
+        if (!changed && !tripReached[connection.tripId] && arrivalTime[connection.departureStopId] > connection.departureTime) return;
+        tripReached[connection.tripId] = true;
+        if (arrivalTime[connection.arrivalStopId] <= connection.arrivalTime) return;
+        arrivalTime[connection.arrivalStopId] = connection.arrivalTime;
+        for (const Edge edge : data.transferGraph.edgesFrom(connection.arrivalStopId)) {
+            const Vertex to = data.transferGraph.get(ToVertex, edge);
+            if (!data.isStop(to)) continue;
+            arrivalTime[to] = std::min(arrivalTime[to], connection.arrivalTime + data.transferGraph.get(TravelTime, edge));
+        }
+    }
+
+private:
+    const CSA::Data& oldData;
+    const CSA::Data& newData;
+    const bool periodic;
+    const int periodicHorizon;
+    const bool sameTransferGraph;
+
+    std::vector<ConnectionId> newConnectionOfOld;
+    std::vector<ConnectionId> oldConnectionOfNew;
+    size_t numberOfChangedOldTrips;
+    size_t numberOfChangedNewTrips;
+    size_t numberOfChangedOldConnections;
+    size_t numberOfChangedNewConnections;
+
+    std::vector<bool> isAffectedVertex;
+
+};
+
+}
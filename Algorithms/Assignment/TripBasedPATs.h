@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+
+#include "../../DataStructures/Assignment/Profile.h"
+#include "../../DataStructures/Assignment/StopLabel.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/PeriodicTimetable.h"
+
+#include "../../Helpers/Vector/Vector.h"
+
+#include "AccessWalking.h"
+#include "PATFile.h"
+#include "Profiler.h"
+
+namespace Assignment {
+
+// Transfers from the arrival of every connection to the departures of the stops within walking distance, which do not
+// depend on the destination. The departures of a stop are sorted by departure time, such that a transfer is described
+// by the range of departures that can be reached within the maximum delay, followed by the first departure after it.
+// Footpaths to stops without a reachable departure are pruned.
+class TripTransfers {
+
+public:
+    struct Transfer {
+        uint32_t begin; // first reachable departure
+        uint32_t end; // first departure that is reachable with certainty
+        int walkingTime;
+        int bufferTime;
+    };
+
+public:
+    TripTransfers() : maxDelay(-1), useTransferBufferTimes(false) {}
+
+    TripTransfers(const CSA::Data& data, const int maxDelay, const bool useTransferBufferTimes) :
+        maxDelay(maxDelay),
+        useTransferBufferTimes(useTransferBufferTimes) {
+        // Every stop is followed by a sentinel slot, which is the end of all transfers that reach no later departure
+        stopBegin.assign(data.numberOfStops() + 1, 0);
+        for (const CSA::Connection& connection : data.connections) {
+            stopBegin[size_t(connection.departureStopId) + 1]++;
+        }
+        for (size_t stop = 0; stop < data.numberOfStops(); stop++) {
+            stopBegin[stop + 1] += stopBegin[stop] + 1;
+        }
+        departures.assign(stopBegin.back(), noConnection);
+        positionOfConnection.assign(data.numberOfConnections(), 0);
+        std::vector<uint32_t> nextPosition(stopBegin.begin(), stopBegin.end() - 1);
+        for (const ConnectionId i : data.connectionIds()) {
+            AssertMsg(i == 0 || data.connections[i - 1].departureTime <= data.connections[i].departureTime, "Connections are not sorted by departure time!");
+            const uint32_t position = nextPosition[data.connections[i].departureStopId]++;
+            departures[position] = i;
+            positionOfConnection[i] = position;
+        }
+
+        struct Footpath {
+            StopId stop;
+            int walkingTime;
+            int bufferTime;
+        };
+        std::vector<std::vector<Footpath>> footpathsOfStop(data.numberOfStops());
+        for (const StopId stop : data.stops()) {
+            footpathsOfStop[stop].emplace_back(Footpath{stop, 0, data.minTransferTime(stop)});
+            for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                const Vertex neighbor = data.transferGraph.get(ToVertex, edge);
+                if (!data.isStop(neighbor)) continue;
+                footpathsOfStop[stop].emplace_back(Footpath{StopId(neighbor), data.transferGraph.get(TravelTime, edge), useTransferBufferTimes ? data.minTransferTime(StopId(neighbor)) : 0});
+            }
+        }
+
+        std::vector<std::vector<Transfer>> transfersOfConnection(data.numberOfConnections());
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (size_t i = 0; i < data.numberOfConnections(); i++) {
+            const CSA::Connection& connection = data.connections[i];
+            for (const Footpath& footpath : footpathsOfStop[connection.arrivalStopId]) {
+                const int time = connection.arrivalTime + footpath.walkingTime + footpath.bufferTime;
+                const uint32_t begin = firstDepartureAfter(data, footpath.stop, stopBegin[footpath.stop], time);
+                if (begin == stopBegin[size_t(footpath.stop) + 1] - 1) continue;
+                const uint32_t end = (maxDelay > 0) ? firstDepartureAfter(data, footpath.stop, begin, time + maxDelay) : begin;
+                transfersOfConnection[i].emplace_back(Transfer{begin, end, footpath.walkingTime, footpath.bufferTime});
+            }
+        }
+        transferBegin.assign(1, 0);
+        for (const std::vector<Transfer>& transfersOfOneConnection : transfersOfConnection) {
+            transfers.insert(transfers.end(), transfersOfOneConnection.begin(), transfersOfOneConnection.end());
+            transferBegin.emplace_back(transfers.size());
+        }
+    }
+
+    inline bool isCompatible(const int delay, const bool transferBufferTimes) const noexcept {
+        return !transferBegin.empty() && (maxDelay == delay || (maxDelay <= 0 && delay <= 0)) && (useTransferBufferTimes == transferBufferTimes);
+    }
+
+    inline size_t numberOfTransfers() const noexcept {
+        return transfers.size();
+    }
+
+    inline size_t numberOfSlots() const noexcept {
+        return departures.size();
+    }
+
+    inline size_t byteSize() const noexcept {
+        return Vector::byteSize(stopBegin) + Vector::byteSize(departures) + Vector::byteSize(positionOfConnection) + Vector::byteSize(transferBegin) + Vector::byteSize(transfers);
+    }
+
+private:
+    inline uint32_t firstDepartureAfter(const CSA::Data& data, const StopId stop, const uint32_t begin, const int time) const noexcept {
+        return std::lower_bound(departures.begin() + begin, departures.begin() + stopBegin[size_t(stop) + 1] - 1, time, [&](const ConnectionId i, const int t) {
+            return data.connections[i].departureTime < t;
+        }) - departures.begin();
+    }
+
+public:
+    int maxDelay;
+    bool useTransferBufferTimes;
+    std::vector<uint32_t> stopBegin;
+    std::vector<ConnectionId> departures;
+    std::vector<uint32_t> positionOfConnection;
+    std::vector<size_t> transferBegin;
+    std::vector<Transfer> transfers;
+};
+
+// Alternative to ComputePATs with the same interface and results: Instead of relaxing the footpaths during the scan,
+// the transfers between trips are precomputed once per network (TripTransfers). For every departure slot, the scan
+// keeps the best departure at the same stop that is not earlier, so a transfer is evaluated by a single lookup (or by
+// merging the range of delayed departures for maxDelay > 0).
+template<typename PROFILER = NoPATProfiler, bool USE_TRANSFER_BUFFER_TIMES = false>
+class TripBasedPATs {
+
+public:
+    using Profiler = PROFILER;
+    static constexpr bool UseTransferBufferTimes = USE_TRANSFER_BUFFER_TIMES;
+    static constexpr bool UsesTripTransfers = true;
+    using Type = TripBasedPATs<Profiler, UseTransferBufferTimes>;
+
+    struct ConnectionLabel {
+        PerceivedTime tripPAT{Unreachable};
+        PerceivedTime transferPAT{Unreachable};
+        PerceivedTime skipPAT{Unreachable};
+    };
+
+private:
+    struct DepartureEntry {
+        int departureTime{INFTY};
+        ConnectionId connectionId{noConnection};
+        PerceivedTime pat{Unreachable};
+    };
+
+public:
+    TripBasedPATs(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Profiler& profiler = Profiler()) :
+        data(data),
+        reverseGraph(reverseGraph),
+        connectionLabels(data.numberOfConnections()),
+        tripPAT(data.numberOfTrips(), Unreachable),
+        stopLabels(data.numberOfStops()),
+        transferDistanceToTarget(data.numberOfStops(), INFTY),
+        targetVertex(noVertex),
+        connectionPenalties(nullptr),
+        sharedTransfers(nullptr),
+        profiler(profiler) {
+    }
+
+    // Perceived time that is added for traveling along a connection, e.g. for crowding. Use nullptr to disable penalties.
+    inline void setConnectionPenalties(const std::vector<PerceivedTime>* penalties) noexcept {
+        AssertMsg(!penalties || penalties->size() == data.numberOfConnections(), "Number of connection penalties does not match the number of connections!");
+        connectionPenalties = penalties;
+    }
+
+    // Penalty that is added to the PAT of connection i, including all its arrival options
+    inline PerceivedTime connectionPenalty(const ConnectionId i) const noexcept {
+        return connectionPenalties ? (*connectionPenalties)[i] : 0;
+    }
+
+    inline bool hasConnectionPenalties() const noexcept {
+        return connectionPenalties;
+    }
+
+    // Precomputed transfers that are shared with other instances. Without them, the transfers are computed by the first run.
+    inline void setTransfers(const TripTransfers* transfers) noexcept {
+        sharedTransfers = transfers;
+    }
+
+    inline const TripTransfers& getTransfers() const noexcept {
+        return sharedTransfers ? *sharedTransfers : ownTransfers;
+    }
+
+    // The footpaths are part of the precomputed transfers, so the relaxation settings of ComputePATs do not apply.
+    inline void setStopReverseGraph(const CSA::TransferGraph*) noexcept {}
+    inline void setPullFootpaths(const bool) noexcept {}
+
+    // The transfers are computed for the connections of the data, which do not include the copies of the next day.
+    inline void setPeriodicTimetable(const CSA::PeriodicTimetable* timetable) noexcept {
+        Ensure(!timetable, "The trip-based PAT computation does not support periodic timetables!");
+    }
+
+    inline const CSA::PeriodicTimetable* getPeriodicTimetable() const noexcept {
+        return nullptr;
+    }
+
+    inline void setAccessWalking(const AccessWalking* walking) noexcept {
+        Ensure(!walking, "The trip-based PAT computation does not support CH access walking!");
+    }
+
+    inline const AccessWalking* getAccessWalking() const noexcept {
+        return nullptr;
+    }
+
+    inline void run(const Vertex target, const int maxDelay, const int transferCost, const double walkingCosts = 0.0, const double waitingCosts = 0.0) noexcept {
+        if (sharedTransfers && !sharedTransfers->isCompatible(maxDelay, UseTransferBufferTimes)) sharedTransfers = nullptr;
+        if (!sharedTransfers && !ownTransfers.isCompatible(maxDelay, UseTransferBufferTimes)) {
+            ownTransfers = TripTransfers(data, maxDelay, UseTransferBufferTimes);
+        }
+        const TripTransfers& transfers = getTransfers();
+        profiler.startInitialization();
+        clear();
+        initialize(target, walkingCosts);
+        profiler.doneInitialization();
+        for (ConnectionId i = ConnectionId(data.numberOfConnections() - 1); i < data.numberOfConnections(); i--) {
+            profiler.scanConnection(i);
+            const CSA::Connection& connection = data.connections[i];
+            const uint32_t position = transfers.positionOfConnection[i];
+            const ProfileEntry& skipEntry = stopLabels[connection.departureStopId].getSkipEntry();
+
+            AssertMsg(skipEntry.departureTime >= connection.departureTime, "Connections are scanned out of order (" << skipEntry.departureTime << " before " << connection.departureTime << ", index: " << i << ")!");
+            connectionLabels[i].tripPAT = tripPAT[connection.tripId];
+            connectionLabels[i].transferPAT = evaluateTransfers(transfers, i, connection.arrivalTime, maxDelay, walkingCosts, waitingCosts) + transferCost;
+            connectionLabels[i].skipPAT = skipEntry.evaluate(connection.departureTime, waitingCosts);
+            profiler.evaluateProfile();
+
+            PerceivedTime pat = std::min(std::min(connectionLabels[i].tripPAT, targetPAT(connection)), connectionLabels[i].transferPAT);
+            if (pat < Unreachable) pat += connectionPenalty(i);
+            tripPAT[connection.tripId] = pat;
+            if (pat >= connectionLabels[i].skipPAT) {
+                bestDeparture[position] = bestDeparture[position + 1];
+                continue;
+            }
+
+            AssertMsg(pat < Unreachable, "Adding infinity PAT = " << pat << "!");
+            stopLabels[connection.departureStopId].addWaitingEntry(ProfileEntry(connection.departureTime, i, pat, waitingCosts));
+            profiler.addToProfile();
+            bestDeparture[position] = DepartureEntry{connection.departureTime, i, pat};
+        }
+    }
+
+    inline const ConnectionLabel& connectionLabel(const ConnectionId i) const noexcept {
+        return connectionLabels[i];
+    }
+
+    inline PerceivedTime targetPAT(const CSA::Connection& connection) const noexcept {
+        const int distance = transferDistanceToTarget[connection.arrivalStopId];
+        return (distance < INFTY) ? (connection.arrivalTime + distance) : Unreachable;
+    }
+
+    inline const Profile& getProfile(const StopId source) const noexcept {
+        return stopLabels[source].getWaitingProfile();
+    }
+
+    inline Profiler& getProfiler() noexcept {
+        return profiler;
+    }
+
+    // Same format as ComputePATs::writeBinary(), so both engines can share a PAT cache.
+    inline void writeBinary(const std::string& fileName) const noexcept {
+        PATFile::Write(fileName, targetVertex, connectionLabels, data.numberOfStops(), [&](const StopId stop) -> const Profile& {
+            return getProfile(stop);
+        });
+    }
+
+    inline void readBinary(const std::string& fileName, const Vertex target, const double walkingCosts = 0.0) noexcept {
+        clear();
+        initialize(target, walkingCosts);
+        const PATFile file(fileName);
+        Ensure(file.target() == target, "File " << fileName << " contains PATs for target " << file.target() << " instead of " << target << "!");
+        Ensure(file.numberOfStops() == data.numberOfStops(), "File " << fileName << " was computed for a different network!");
+        file.readConnectionLabels(connectionLabels);
+        Profile profile;
+        for (const StopId stop : data.stops()) {
+            file.readProfile(stop, profile);
+            stopLabels[stop].setWaitingProfile(profile.begin(), profile.end());
+        }
+    }
+
+private:
+    inline void clear() noexcept {
+        Vector::fill(tripPAT, Unreachable);
+        Vector::fill(stopLabels);
+        bestDeparture.assign(getTransfers().numberOfSlots(), DepartureEntry());
+        if (reverseGraph.isVertex(targetVertex)) cleanUp();
+    }
+
+    inline void initialize(const Vertex target, const double walkingCosts = 0.0) noexcept {
+        targetVertex = target;
+        for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
+            profiler.relaxEdge(edge);
+            const Vertex stop = reverseGraph.get(ToVertex, edge);
+            if (!data.isStop(stop)) continue;
+            transferDistanceToTarget[stop] = (walkingCosts + 1) * reverseGraph.get(TravelTime, edge);
+        }
+        if (data.isStop(targetVertex)) transferDistanceToTarget[targetVertex] = 0;
+    }
+
+    inline void cleanUp() noexcept {
+        for (const Edge edge : reverseGraph.edgesFrom(targetVertex)) {
+            profiler.relaxEdge(edge);
+            const Vertex stop = reverseGraph.get(ToVertex, edge);
+            if (!data.isStop(stop)) continue;
+            transferDistanceToTarget[stop] = INFTY;
+        }
+        if (data.isStop(targetVertex)) transferDistanceToTarget[targetVertex] = INFTY;
+    }
+
+    // Evaluates the transfer profile of the arrival stop, which consists of the improving departures in the range of
+    // every transfer and the best departure after it (see ComputePATs::pullTransferPAT()).
+    inline PerceivedTime evaluateTransfers(const TripTransfers& transfers, const ConnectionId i, const int time, const int maxDelay, const double walkingCosts, const double waitingCosts) noexcept {
+        if (maxDelay <= 0) {
+            PerceivedTime pat = std::numeric_limits<PerceivedTime>::infinity();
+            for (size_t t = transfers.transferBegin[i]; t < transfers.transferBegin[size_t(i) + 1]; t++) {
+                const TripTransfers::Transfer& transfer = transfers.transfers[t];
+                profiler.relaxEdge(Edge(t));
+                const DepartureEntry& departure = bestDeparture[transfer.begin];
+                if (departure.connectionId == noConnection) continue;
+                pat = std::min(pat, ProfileEntry(departure.departureTime, departure.connectionId, departure.pat, transfer.walkingTime, transfer.bufferTime, walkingCosts, waitingCosts).evaluate(time, waitingCosts));
+            }
+            return pat;
+        }
+        candidates.clear();
+        for (size_t t = transfers.transferBegin[i]; t < transfers.transferBegin[size_t(i) + 1]; t++) {
+            const TripTransfers::Transfer& transfer = transfers.transfers[t];
+            profiler.relaxEdge(Edge(t));
+            for (uint32_t position = transfer.begin; position < transfer.end; position++) {
+                const DepartureEntry& departure = bestDeparture[position];
+                if (departure.connectionId != transfers.departures[position]) continue;
+                candidates.emplace_back(departure.departureTime, departure.connectionId, departure.pat, transfer.walkingTime, transfer.bufferTime, walkingCosts, waitingCosts);
+            }
+            const DepartureEntry& departure = bestDeparture[transfer.end];
+            if (departure.connectionId == noConnection) continue;
+            candidates.emplace_back(departure.departureTime, departure.connectionId, departure.pat, transfer.walkingTime, transfer.bufferTime, walkingCosts, waitingCosts);
+        }
+        return StopLabel::evaluateWithDelay(candidates, transferProfile, time, maxDelay, waitingCosts);
+    }
+
+private:
+    const CSA::Data& data;
+    const CSA::TransferGraph& reverseGraph;
+
+    std::vector<ConnectionLabel> connectionLabels;
+    std::vector<PerceivedTime> tripPAT;
+    std::vector<StopLabel> stopLabels;
+    std::vector<int> transferDistanceToTarget;
+    Vertex targetVertex;
+    const std::vector<PerceivedTime>* connectionPenalties;
+
+    const TripTransfers* sharedTransfers;
+    TripTransfers ownTransfers;
+    // Best departure at the stop of the departure slot that is not earlier than the slot (see TripTransfers)
+    std::vector<DepartureEntry> bestDeparture;
+    std::vector<ProfileEntry> candidates;
+    Profile transferProfile;
+
+    Profiler profiler;
+
+};
+
+}
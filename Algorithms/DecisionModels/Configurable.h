@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <variant>
+#include <vector>
+
+#include "../../DataStructures/Assignment/Settings.h"
+
+#include "../../Helpers/Types.h"
+
+#include "Kirchhoff.h"
+#include "Linear.h"
+#include "Logit.h"
+#include "Optimal.h"
+#include "RelativeLogit.h"
+
+namespace DecisionModels {
+
+// Decision model that is chosen at runtime according to settings.decisionModel, such that assignments with different
+// decision models can share the same worker type (and thus the same PATs).
+class Configurable {
+
+private:
+    using Model = std::variant<Linear, Logit, Kirchhoff, RelativeLogit, Optimal>;
+
+public:
+    Configurable(const Assignment::Settings& settings) :
+        model(createModel(settings)) {
+    }
+
+    inline void cumulativeDistribution(const std::vector<int>& values, std::vector<int>& result) const noexcept {
+        std::visit([&](const auto& m) {m.cumulativeDistribution(values, result);}, model);
+    }
+
+    inline std::vector<int> cumulativeDistribution(const std::vector<int>& values) const noexcept {
+        std::vector<int> result;
+        cumulativeDistribution(values, result);
+        return result;
+    }
+
+    inline std::array<int, 2> cumulativeDistribution(const double a, const double b) const noexcept {
+        return std::visit([&](const auto& m) {return m.cumulativeDistribution(a, b);}, model);
+    }
+
+    inline void distribution(const std::vector<int>& values, std::vector<int>& result) const noexcept {
+        std::visit([&](const auto& m) {m.distribution(values, result);}, model);
+    }
+
+    inline std::vector<int> distribution(const std::vector<int>& values) const noexcept {
+        std::vector<int> result;
+        distribution(values, result);
+        return result;
+    }
+
+    inline std::array<int, 3> distribution(const double a, const double b) const noexcept {
+        return std::visit([&](const auto& m) {return m.distribution(a, b);}, model);
+    }
+
+private:
+    inline static Model createModel(const Assignment::Settings& settings) noexcept {
+        switch (settings.decisionModel) {
+            case 1: return Model(std::in_place_type<Logit>, settings);
+            case 2: return Model(std::in_place_type<Kirchhoff>, settings);
+            case 3: return Model(std::in_place_type<RelativeLogit>, settings);
+            case 4: return Model(std::in_place_type<Optimal>, settings);
+            default: return Model(std::in_place_type<Linear>, settings);
+        }
+    }
+
+private:
+    const Model model;
+
+};
+
+}
@@ -10,15 +10,21 @@
 #include "../../Helpers/String/String.h"
 #include "../../Helpers/Vector/Vector.h"
 
+#include "ValueTable.h"
+
 namespace DecisionModels {
 
 class Kirchhoff {
 
 public:
-    Kirchhoff(const int delayTolerance, const double beta = 1) :
+    // With tabulate = false, std::pow is evaluated for every option, as in decisionModelBenchmark
+    Kirchhoff(const int delayTolerance, const double beta = 1, const bool tabulate = true) :
         delayTolerance(delayTolerance),
         beta(beta),
-        norm(10000.0 / std::pow((double)(delayTolerance), beta)) {
+        norm(10000.0 / std::pow((double)(delayTolerance), beta)),
+        table(tabulate ? ValueTable(0, delayTolerance + 1, [&](const int difference) {
+            return (difference <= delayTolerance) ? computeKirchhoffValue(difference) : 0;
+        }) : ValueTable()) {
     }
     Kirchhoff(const Assignment::Settings& settings) :
         Kirchhoff(settings.delayTolerance, settings.beta) {
@@ -34,9 +40,9 @@ public:
                 result[i] = (values[i] == minValues[0]) ? 1 : result[i - 1];
             }
         } else {
-            result[0] = (values[0] - minValues[0] <= delayTolerance) ? kirchhoffValue(values[0], minValues[0]) : 0;
+            result[0] = kirchhoffValue(values[0] - minValues[0]);
             for (size_t i = 1; i < values.size(); i++) {
-                result[i] = result[i - 1] + ((values[i] - minValues[0] <= delayTolerance) ? kirchhoffValue(values[i], minValues[0]) : 0);
+                result[i] = result[i - 1] + kirchhoffValue(values[i] - minValues[0]);
                 AssertMsg(result[i] >= result[i - 1], "Accumulated values are decreasing from " << String::prettyInt(result[i - 1]) << " to " << String::prettyInt(result[i]) << "!");
             }
         }
@@ -56,8 +62,8 @@ public:
             return std::array<int, 2>{0, 1};
         } else {
             const int minValue = std::min(a, b);
-            const int valueA = kirchhoffValue(a, minValue);
-            const int valueB = kirchhoffValue(b, minValue);
+            const int valueA = kirchhoffValue(a - minValue);
+            const int valueB = kirchhoffValue(b - minValue);
             AssertMsg(valueA + valueB > 0, "Probability of all options cannot be zero (" << a << ", " << b << ")!");
             return std::array<int, 2>{valueA, valueA + valueB};
         }
@@ -67,19 +73,20 @@ public:
         if (values.empty()) return;
         const std::array<int, 2> minValues = Vector::twoSmallestValues(values);
         result.resize(values.size() + 1);
-        result.back() = 0;
+        int sum = 0;
         if (minValues[1] - minValues[0] > delayTolerance) {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = (values[i] == minValues[0]) ? 1 : 0;
-                result.back() += result[i];
+                sum += result[i];
             }
         } else {
             for (size_t i = 0; i < values.size(); i++) {
-                result[i] = (values[i] - minValues[0] <= delayTolerance) ? kirchhoffValue(values[i], minValues[0]) : 0;
+                result[i] = kirchhoffValue(values[i] - minValues[0]);
                 AssertMsg(result[i] >= 0, "Kirchhoff value is negative ( " << String::prettyInt(result[i]) << ")!");
-                result.back() += result[i];
+                sum += result[i];
             }
         }
+        result.back() = sum;
         AssertMsg(result.back() > 0, "Probability of all options cannot be zero!");
     }
 
@@ -96,21 +103,28 @@ public:
             return std::array<int, 3>{0, 1, 1};
         } else {
             const int minValue = std::min(a, b);
-            const int valueA = kirchhoffValue(a, minValue);
-            const int valueB = kirchhoffValue(b, minValue);
+            const int valueA = kirchhoffValue(a - minValue);
+            const int valueB = kirchhoffValue(b - minValue);
             AssertMsg(valueA + valueB > 0, "Probability of all options cannot be zero (" << a << ", " << b << ")!");
             return std::array<int, 3>{valueA, valueB, valueA + valueB};
         }
     }
 
 private:
-    inline int kirchhoffValue(const int value, const int minValue) const noexcept {
-        return norm * std::pow(static_cast<double>(minValue - value + delayTolerance), beta);
+    // Value of an option whose PAT exceeds the minimum PAT by the given difference
+    inline int kirchhoffValue(const int difference) const noexcept {
+        if (!table.empty()) return table[difference];
+        return (difference <= delayTolerance) ? computeKirchhoffValue(difference) : 0;
+    }
+
+    inline int computeKirchhoffValue(const int difference) const noexcept {
+        return norm * std::pow(static_cast<double>(delayTolerance - difference), beta);
     }
 
     const int delayTolerance;
     const double beta;
     const double norm;
+    const ValueTable table;
 
 };
 
@@ -66,19 +66,20 @@ public:
         if (values.empty()) return;
         const std::array<int, 2> minValues = Vector::twoSmallestValues(values);
         result.resize(values.size() + 1);
-        result.back() = 0;
+        int sum = 0;
         if (minValues[1] - minValues[0] > delayTolerance) {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = (values[i] == minValues[0]) ? 1 : 0;
-                result.back() += result[i];
+                sum += result[i];
             }
         } else {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = gain(values[i], minValues);
                 AssertMsg(result[i] >= 0, "Gain is negative ( " << String::prettyInt(result[i]) << ")!");
-                result.back() += result[i];
+                sum += result[i];
             }
         }
+        result.back() = sum;
         AssertMsg(result.back() > 0, "Probability of all options cannot be zero!");
     }
 
@@ -100,9 +101,8 @@ public:
 
 private:
     inline int gain(const int value, const std::array<int, 2>& minValues) const noexcept {
-        if (value - minValues[0] > delayTolerance) return 0;
         const int minValue = (value == minValues[0]) ? minValues[1] : minValues[0];
-        return minValue - value + delayValue;
+        return (value - minValues[0] > delayTolerance) ? 0 : minValue - value + delayValue;
     }
 
 private:
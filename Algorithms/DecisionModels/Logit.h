@@ -10,14 +10,20 @@
 #include "../../Helpers/String/String.h"
 #include "../../Helpers/Vector/Vector.h"
 
+#include "ValueTable.h"
+
 namespace DecisionModels {
 
 class Logit {
 
 public:
-    Logit(const int delayTolerance, const double beta = 1) :
+    // Without tabulate, std::exp is evaluated for every option (used as a reference for the table)
+    Logit(const int delayTolerance, const double beta = 1, const bool tabulate = true) :
         delayTolerance(delayTolerance),
-        beta(beta) {
+        beta(beta),
+        table(tabulate ? ValueTable(0, delayTolerance + 1, [&](const int difference) {
+            return (difference <= delayTolerance) ? computeLogitValue(difference) : 0;
+        }) : ValueTable()) {
     }
     Logit(const Assignment::Settings& settings) :
         Logit(settings.delayTolerance, settings.beta) {
@@ -33,9 +39,9 @@ public:
                 result[i] = (values[i] == minValues[0]) ? 1 : result[i - 1];
             }
         } else {
-            result[0] = (values[0] - minValues[0] <= delayTolerance) ? logitValue(values[0], minValues[0]) : 0;
+            result[0] = logitValue(values[0] - minValues[0]);
             for (size_t i = 1; i < values.size(); i++) {
-                result[i] = result[i - 1] + ((values[i] - minValues[0] <= delayTolerance) ? logitValue(values[i], minValues[0]) : 0);
+                result[i] = result[i - 1] + logitValue(values[i] - minValues[0]);
                 AssertMsg(result[i] >= result[i - 1], "Accumulated values are decreasing from " << String::prettyInt(result[i - 1]) << " to " << String::prettyInt(result[i]) << "!");
             }
         }
@@ -55,8 +61,8 @@ public:
             return std::array<int, 2>{0, 1};
         } else {
             const int minValue = std::min(a, b);
-            const int valueA = logitValue(a, minValue);
-            const int valueB = logitValue(b, minValue);
+            const int valueA = logitValue(a - minValue);
+            const int valueB = logitValue(b - minValue);
             AssertMsg(valueA + valueB > 0, "Probability of all options cannot be zero (" << a << ", " << b << ")!");
             return std::array<int, 2>{valueA, valueA + valueB};
         }
@@ -66,19 +72,20 @@ public:
         if (values.empty()) return;
         const std::array<int, 2> minValues = Vector::twoSmallestValues(values);
         result.resize(values.size() + 1);
-        result.back() = 0;
+        int sum = 0;
         if (minValues[1] - minValues[0] > delayTolerance) {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = (values[i] == minValues[0]) ? 1 : 0;
-                result.back() += result[i];
+                sum += result[i];
             }
         } else {
             for (size_t i = 0; i < values.size(); i++) {
-                result[i] = (values[i] - minValues[0] <= delayTolerance) ? logitValue(values[i], minValues[0]) : 0;
+                result[i] = logitValue(values[i] - minValues[0]);
                 AssertMsg(result[i] >= 0, "Logit value is negative ( " << String::prettyInt(result[i]) << ")!");
-                result.back() += result[i];
+                sum += result[i];
             }
         }
+        result.back() = sum;
         AssertMsg(result.back() > 0, "Probability of all options cannot be zero!");
     }
 
@@ -95,21 +102,28 @@ public:
             return std::array<int, 3>{0, 1, 1};
         } else {
             const int minValue = std::min(a, b);
-            const int valueA = logitValue(a, minValue);
-            const int valueB = logitValue(b, minValue);
+            const int valueA = logitValue(a - minValue);
+            const int valueB = logitValue(b - minValue);
             AssertMsg(valueA + valueB > 0, "Probability of all options cannot be zero (" << a << ", " << b << ")!");
             return std::array<int, 3>{valueA, valueB, valueA + valueB};
         }
     }
 
 private:
-    inline int logitValue(const int value, const int minValue) const noexcept {
-        return std::exp(10 + (beta * (minValue - value)));
+    // Value of an option whose PAT exceeds the minimum PAT by the given difference
+    inline int logitValue(const int difference) const noexcept {
+        if (!table.empty()) return table[difference];
+        return (difference <= delayTolerance) ? computeLogitValue(difference) : 0;
+    }
+
+    inline int computeLogitValue(const int difference) const noexcept {
+        return std::exp(10 + (beta * (-difference)));
     }
 
 private:
     const int delayTolerance;
     const double beta;
+    const ValueTable table;
 
 };
 
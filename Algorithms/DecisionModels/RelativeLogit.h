@@ -10,15 +10,18 @@
 #include "../../Helpers/String/String.h"
 #include "../../Helpers/Vector/Vector.h"
 
+#include "ValueTable.h"
+
 namespace DecisionModels {
 
 class RelativeLogit {
 
 public:
-    RelativeLogit(const int delayTolerance, const double beta = 1) :
+    RelativeLogit(const int delayTolerance, const double beta = 1, const bool tabulate = true) :
         delayTolerance(delayTolerance),
         beta(beta),
-        logNorm(10 - (2 * beta * delayTolerance)) {
+        logNorm(10 - (2 * beta * delayTolerance)),
+        table(createTable(tabulate)) {
     }
     RelativeLogit(const Assignment::Settings& settings) :
         RelativeLogit(settings.delayTolerance, settings.beta) {
@@ -66,19 +69,20 @@ public:
         if (values.empty()) return;
         const std::array<int, 2> minValues = Vector::twoSmallestValues(values);
         result.resize(values.size() + 1);
-        result.back() = 0;
+        int sum = 0;
         if (minValues[1] - minValues[0] > delayTolerance) {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = (values[i] == minValues[0]) ? 1 : 0;
-                result.back() += result[i];
+                sum += result[i];
             }
         } else {
             for (size_t i = 0; i < values.size(); i++) {
                 result[i] = relativeLogitValue(values[i], minValues[0]);
                 AssertMsg(result[i] >= 0, "Relative logit value is negative ( " << String::prettyInt(result[i]) << ")!");
-                result.back() += result[i];
+                sum += result[i];
             }
         }
+        result.back() = sum;
         AssertMsg(result.back() > 0, "Probability of all options cannot be zero!");
     }
 
@@ -104,16 +108,43 @@ public:
 private:
     inline int relativeLogitValue(const int value, const std::array<int, 2> minValues) const noexcept {
         const int otherValue = (value == minValues[0]) ? minValues[1] : minValues[0];
-        return std::exp(logNorm + (beta * std::max(0, otherValue - value + delayTolerance)));
+        return relativeLogitValue(std::max(0, otherValue - value + delayTolerance));
     }
 
     inline int relativeLogitValue(const int value, const int otherValue) const noexcept {
-        return std::exp(logNorm + (beta * (otherValue - value + delayTolerance)));
+        return relativeLogitValue(otherValue - value + delayTolerance);
+    }
+
+    inline int relativeLogitValue(const int argument) const noexcept {
+        if (!table.empty()) return table[argument];
+        return computeRelativeLogitValue(argument);
+    }
+
+    inline int computeRelativeLogitValue(const int argument) const noexcept {
+        return std::exp(logNorm + (beta * argument));
     }
 
+    // The arguments are at most 2 * delayTolerance. For beta > 0, the values decrease to zero for smaller arguments, and
+    // the table starts at the largest argument with value zero, such that clamping smaller arguments is exact. For
+    // beta < 0, the values are evaluated directly.
+    inline ValueTable createTable(const bool tabulate) const noexcept {
+        if (!tabulate || beta < 0) return ValueTable();
+        int minArgument = 0;
+        while (beta > 0 && computeRelativeLogitValue(minArgument) > 0) {
+            if (minArgument <= -MaxTableSize) return ValueTable();
+            minArgument--;
+        }
+        return ValueTable(minArgument, 2 * delayTolerance, [&](const int argument) {
+            return computeRelativeLogitValue(argument);
+        });
+    }
+
+    inline static constexpr int MaxTableSize = 1 << 20;
+
     const int delayTolerance;
     const double beta;
     const double logNorm;
+    const ValueTable table;
 
 };
 
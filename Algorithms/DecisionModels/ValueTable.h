@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace DecisionModels {
+
+// Values of a decision model for all integer arguments in [minArgument, maxArgument]. Since PATs are integers, the
+// arguments of std::exp or std::pow in the decision models are integers as well, and the table yields exactly the same
+// values while avoiding their evaluation for every option. Arguments outside the range are clamped to the first or last
+// entry, so the table has to contain all arguments with a value different from the values at its borders.
+class ValueTable {
+
+public:
+    ValueTable() :
+        minArgument(0),
+        maxArgument(-1) {
+    }
+    template<typename FUNCTION>
+    ValueTable(const int minArgument, const int maxArgument, const FUNCTION& function) :
+        minArgument(minArgument),
+        maxArgument(maxArgument) {
+        AssertMsg(minArgument <= maxArgument, "Table range [" << minArgument << ", " << maxArgument << "] is empty!");
+        values.reserve(maxArgument - minArgument + 1);
+        for (int argument = minArgument; argument <= maxArgument; argument++) {
+            values.emplace_back(function(argument));
+        }
+    }
+
+    inline bool empty() const noexcept {
+        return values.empty();
+    }
+
+    inline int operator[](const int argument) const noexcept {
+        AssertMsg(!empty(), "Table is empty!");
+        return values[std::min(std::max(argument, minArgument), maxArgument) - minArgument];
+    }
+
+    inline long long byteSize() const noexcept {
+        return sizeof(*this) + Vector::byteSize(values);
+    }
+
+private:
+    int minArgument;
+    int maxArgument;
+    std::vector<int> values;
+
+};
+
+}
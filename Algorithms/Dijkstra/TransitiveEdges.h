@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <omp.h>
+
+#include "Dijkstra.h"
+
+#include "../../DataStructures/Graph/Graph.h"
+
+#include "../../Helpers/Console/Progress.h"
+
+// Runs one Dijkstra search from every source in [firstSource, endSource) in parallel, each thread with its own Dijkstra
+// instance. settle(dijkstra, source, vertex, buffer) is called for every settled vertex and may append edges to buffer.
+// Sources are processed in blocks of consecutive vertices with one buffer per block, which are appended to buffers in
+// source order. Thus, the concatenated buffers contain the edges in the same order as a sequential run.
+// The searches can be bounded: edges leading beyond maxTravelTime are pruned, and a search stops after maxNeighbors
+// vertices (excluding the source) have been settled.
+template<typename GRAPH, typename BUFFERED_EDGE, typename SETTLE>
+inline void collectTransitiveEdges(const GRAPH& graph, const Vertex firstSource, const Vertex endSource, std::vector<std::vector<BUFFERED_EDGE>>& buffers, const SETTLE& settle, const bool verbose = false, const int maxTravelTime = intMax, const size_t maxNeighbors = -1) noexcept {
+    static constexpr size_t BlockSize = 64;
+    if (endSource <= firstSource) return;
+    const size_t numberOfSources = endSource - firstSource;
+    const size_t numberOfBlocks = (numberOfSources + BlockSize - 1) / BlockSize;
+    const size_t firstBuffer = buffers.size();
+    buffers.resize(firstBuffer + numberOfBlocks);
+    Progress progress(numberOfSources, verbose);
+    #pragma omp parallel
+    {
+        Dijkstra<GRAPH, false> dijkstra(graph, graph[TravelTime]);
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t block = 0; block < numberOfBlocks; block++) {
+            std::vector<BUFFERED_EDGE>& buffer = buffers[firstBuffer + block];
+            const size_t blockBegin = firstSource + block * BlockSize;
+            const size_t blockEnd = std::min<size_t>(blockBegin + BlockSize, endSource);
+            for (Vertex source = Vertex(blockBegin); source < blockEnd; source++) {
+                size_t settledVertices = 0;
+                dijkstra.run(source, noVertex, [&](const Vertex u) {
+                    settledVertices++;
+                    settle(dijkstra, source, u, buffer);
+                }, [&]() {
+                    return settledVertices > maxNeighbors;
+                }, [&](const Vertex u, const Edge edge) {
+                    return (maxTravelTime != intMax) && (dijkstra.getDistance(u) + graph.get(TravelTime, edge) > maxTravelTime);
+                });
+            }
+            #pragma omp critical
+            progress += blockEnd - blockBegin;
+        }
+    }
+}
@@ -101,23 +101,30 @@ struct AssignmentData {
 
     inline AssignmentData& operator+=(const AssignmentData& other) noexcept {
         const size_t groupOffset = groups.size();
-        for (const GroupData& group : other.groups) {
-            AssertMsg(group.groupId + groupOffset == groups.size(), "Current group id is " << (group.groupId + groupOffset) << ", but should be " << groups.size() << "!");
-            groups.emplace_back(groups.size(), group.demandIndex, group.groupSize);
-            connectionsPerGroup.emplace_back(other.connectionsPerGroup[group.groupId]);
-        }
+        appendGroups(other);
         for (size_t i = 0; i < other.groupsPerConnection.size(); i++) {
             for (const GroupId group : other.groupsPerConnection[i]) {
                 groupsPerConnection[i].emplace_back(group + groupOffset);
             }
         }
+        return *this;
+    }
+
+    // Same as operator+=, but without the groups per connection, which can be added by addGroupsToConnections() once all
+    // groups have been appended. Takes time proportional to the size of other instead of the number of connections.
+    inline void appendGroups(const AssignmentData& other) noexcept {
+        const size_t groupOffset = groups.size();
+        for (const GroupData& group : other.groups) {
+            AssertMsg(group.groupId + groupOffset == groups.size(), "Current group id is " << (group.groupId + groupOffset) << ", but should be " << groups.size() << "!");
+            groups.emplace_back(groups.size(), group.demandIndex, group.groupSize);
+            connectionsPerGroup.emplace_back(other.connectionsPerGroup[group.groupId]);
+        }
         for (const GroupId group : other.unassignedGroups) {
             unassignedGroups.emplace_back(group + groupOffset);
         }
         for (const GroupId group : other.directWalkingGroups) {
             directWalkingGroups.emplace_back(group + groupOffset);
         }
-        return *this;
     }
 
     std::vector<GroupData> groups;
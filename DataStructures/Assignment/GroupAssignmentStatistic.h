@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <sstream>
 #include <vector>
 #include <string>
@@ -127,9 +128,11 @@ private:
         int finalDistance;
     };
 
+    // The Dijkstra searches run on a copy of the transfer graph, which is shared by the copies of the distance.
     struct DijkstraDistance {
-        DijkstraDistance(const TransferGraph& graph) :
-            dijkstra(graph),
+        DijkstraDistance(const CSA::MappedTransferGraph& transferGraph) :
+            graph(std::make_shared<const TransferGraph>(transferGraph.toStaticGraph())),
+            dijkstra(*graph),
             r(false),
             d(0) {
         }
@@ -146,16 +149,18 @@ private:
         inline int getDistance() const noexcept {
             return d;
         }
+        std::shared_ptr<const TransferGraph> graph;
         Dijkstra<TransferGraph> dijkstra;
         bool r;
         int d;
     };
 
     struct BucketDistance {
-        BucketDistance(const TransferGraph& graph, const size_t numberOfStops, const CH::BucketQuery<>& bucketQuery) :
+        BucketDistance(const CSA::MappedTransferGraph& transferGraph, const size_t numberOfStops, const CH::BucketQuery<>& bucketQuery) :
             numberOfStops(numberOfStops),
             bucketQuery(bucketQuery),
-            dijkstra(graph),
+            graph(std::make_shared<const TransferGraph>(transferGraph.toStaticGraph())),
+            dijkstra(*graph),
             r(false),
             d(0) {
         }
@@ -182,6 +187,7 @@ private:
         }
         size_t numberOfStops;
         CH::BucketQuery<> bucketQuery;
+        std::shared_ptr<const TransferGraph> graph;
         Dijkstra<TransferGraph> dijkstra;
         bool r;
         int d;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "AssignmentData.h"
@@ -7,6 +8,7 @@
 #include "Settings.h"
 #include "../CSA/Data.h"
 #include "../Demand/AccumulatedVertexDemand.h"
+#include "../../Algorithms/Assignment/AccessWalking.h"
 #include "../../Helpers/Types.h"
 
 namespace Assignment {
@@ -73,11 +75,13 @@ struct JourneyInfo {
 
 class JourneyWriter {
 public:
-    JourneyWriter(const CSA::Data& data, const Settings& settings, const AccumulatedVertexDemand& demand, const AssignmentData& assignmentData) :
+    // accessWalking: the walking times between zones and stops are taken from shortest paths if there is no direct edge.
+    JourneyWriter(const CSA::Data& data, const Settings& settings, const AccumulatedVertexDemand& demand, const AssignmentData& assignmentData, const AccessWalking* accessWalking = nullptr) :
         data(data),
         settings(settings),
         demand(demand),
-        assignmentData(assignmentData) {
+        assignmentData(assignmentData),
+        accessWalkingQuery(accessWalking ? std::make_unique<AccessWalking::Query>(*accessWalking) : nullptr) {
     }
 
     inline void write(const std::string& fileName) const noexcept {
@@ -118,7 +122,7 @@ private:
     inline int getWalkingTime(const Vertex from, const Vertex to) const noexcept {
         if (from == to) return 0;
         const Edge edge = data.transferGraph.findEdge(from, to);
-        if (edge == noEdge) return INFTY;
+        if (edge == noEdge) return accessWalkingQuery ? accessWalkingQuery->walkingTime(from, to) : INFTY;
         return data.transferGraph.get(TravelTime, edge);
     }
 
@@ -144,9 +148,9 @@ private:
             leg.arrivalStop = data.connections[leg.lastConnection].arrivalStopId;
             leg.departureTime = data.connections[leg.firstConnection].departureTime;
             leg.arrivalTime = data.connections[leg.lastConnection].arrivalTime;
-            journey.tripNames.emplace_back(data.tripData[leg.trip].tripName);
-            journey.departureStopNames.emplace_back(data.stopData[leg.departureStop].name);
-            journey.arrivalStopNames.emplace_back(data.stopData[leg.arrivalStop].name);
+            journey.tripNames.emplace_back(data.getTripData()[leg.trip].tripName);
+            journey.departureStopNames.emplace_back(data.getStopData()[leg.departureStop].name);
+            journey.arrivalStopNames.emplace_back(data.getStopData()[leg.arrivalStop].name);
         }
 
         const AccumulatedVertexDemand::Entry& demandEntry = demand.entries[assignmentData.groups[group].demandIndex];
@@ -194,6 +198,7 @@ private:
     const Settings& settings;
     const AccumulatedVertexDemand& demand;
     const AssignmentData& assignmentData;
+    mutable std::unique_ptr<AccessWalking::Query> accessWalkingQuery;
 };
 
 }
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+
+namespace Assignment {
+
+// Mean and variance of the connection loads over several Monte Carlo replications, accumulated with Welford's method.
+// Alternatively, the loads can be accumulated from independent parts (e.g. the passengers of different destinations,
+// which are assigned with independent random streams), whose means and variances add up.
+class LoadStatistics {
+
+public:
+    LoadStatistics(const size_t numberOfConnections = 0, const size_t numberOfReplications = 0) :
+        numberOfReplications(numberOfReplications),
+        mean(numberOfConnections, 0),
+        sumOfSquaredDeviations(numberOfConnections, 0) {
+    }
+
+    inline void addReplication(const std::vector<double>& load) noexcept {
+        AssertMsg(load.size() == mean.size(), "Number of loads does not match the number of connections!");
+        numberOfReplications++;
+        for (size_t i = 0; i < load.size(); i++) {
+            const double delta = load[i] - mean[i];
+            mean[i] += delta / numberOfReplications;
+            sumOfSquaredDeviations[i] += delta * (load[i] - mean[i]);
+        }
+    }
+
+    // Adds a part of the load of the connection, which is independent of the parts added before.
+    inline void addIndependentLoad(const ConnectionId connection, const double partMean, const double partSumOfSquaredDeviations) noexcept {
+        mean[connection] += partMean;
+        sumOfSquaredDeviations[connection] += partSumOfSquaredDeviations;
+    }
+
+    // Adds loads that are independent of the loads added before, over the same replications.
+    inline LoadStatistics& operator+=(const LoadStatistics& other) noexcept {
+        AssertMsg(other.numberOfReplications == numberOfReplications, "Number of replications does not match!");
+        AssertMsg(other.mean.size() == mean.size(), "Number of connections does not match!");
+        for (size_t i = 0; i < mean.size(); i++) {
+            mean[i] += other.mean[i];
+            sumOfSquaredDeviations[i] += other.sumOfSquaredDeviations[i];
+        }
+        return *this;
+    }
+
+    inline size_t getNumberOfReplications() const noexcept {
+        return numberOfReplications;
+    }
+
+    inline double getMean(const ConnectionId connection) const noexcept {
+        return mean[connection];
+    }
+
+    // Sample variance
+    inline double getVariance(const ConnectionId connection) const noexcept {
+        return (numberOfReplications > 1) ? (sumOfSquaredDeviations[connection] / (numberOfReplications - 1)) : 0.0;
+    }
+
+    inline double getStandardDeviation(const ConnectionId connection) const noexcept {
+        return std::sqrt(getVariance(connection));
+    }
+
+    // Half width of the confidence interval for the mean load (normal approximation, z = 1.96 for 95%).
+    inline double getConfidenceRadius(const ConnectionId connection, const double z = 1.96) const noexcept {
+        return (numberOfReplications > 0) ? (z * std::sqrt(getVariance(connection) / numberOfReplications)) : 0.0;
+    }
+
+private:
+    size_t numberOfReplications;
+    std::vector<double> mean;
+    std::vector<double> sumOfSquaredDeviations;
+
+};
+
+// Loads of a single destination over its replications, accumulated with Welford's method for the connections used by the
+// destination only. The result is added to a LoadStatistics as an independent part of the loads.
+class DestinationLoadStatistics {
+
+public:
+    DestinationLoadStatistics(const size_t numberOfConnections = 0) :
+        numberOfReplications(0),
+        load(numberOfConnections, 0),
+        mean(numberOfConnections, 0),
+        sumOfSquaredDeviations(numberOfConnections, 0),
+        isUsed(numberOfConnections, false) {
+    }
+
+    inline void addLoad(const ConnectionId connection, const double passengers) noexcept {
+        if (!isUsed[connection]) {
+            isUsed[connection] = true;
+            usedConnections.emplace_back(connection);
+        }
+        load[connection] += passengers;
+    }
+
+    // Connections that are used only by later replications have had a load of zero in all previous replications, which
+    // leaves their mean and deviations at zero.
+    inline void doneReplication() noexcept {
+        numberOfReplications++;
+        for (const ConnectionId connection : usedConnections) {
+            const double delta = load[connection] - mean[connection];
+            mean[connection] += delta / numberOfReplications;
+            sumOfSquaredDeviations[connection] += delta * (load[connection] - mean[connection]);
+            load[connection] = 0;
+        }
+    }
+
+    // Adds the loads to statistics and resets the accumulator for the next destination.
+    inline void moveTo(LoadStatistics& statistics) noexcept {
+        AssertMsg(numberOfReplications == statistics.getNumberOfReplications(), "Number of replications is " << numberOfReplications << ", but should be " << statistics.getNumberOfReplications() << "!");
+        for (const ConnectionId connection : usedConnections) {
+            statistics.addIndependentLoad(connection, mean[connection], sumOfSquaredDeviations[connection]);
+            mean[connection] = 0;
+            sumOfSquaredDeviations[connection] = 0;
+            isUsed[connection] = false;
+        }
+        usedConnections.clear();
+        numberOfReplications = 0;
+    }
+
+private:
+    size_t numberOfReplications;
+    std::vector<double> load;
+    std::vector<double> mean;
+    std::vector<double> sumOfSquaredDeviations;
+    std::vector<bool> isUsed;
+    std::vector<ConnectionId> usedConnections;
+
+};
+
+}
@@ -28,6 +28,15 @@ public:
         normalizedPAT(originalPAT + ((departureTime - transferTime) * waitingCosts) + (transferTime * walkingCosts)) {
     }
 
+    // Restores an entry from its stored representation (see getNormalizedPAT()).
+    inline static ProfileEntry FromNormalizedPAT(const int departureTime, const ConnectionId connectionId, const PerceivedTime normalizedPAT) noexcept {
+        ProfileEntry entry;
+        entry.departureTime = departureTime;
+        entry.connectionId = connectionId;
+        entry.normalizedPAT = normalizedPAT;
+        return entry;
+    }
+
     inline bool operator<(const ProfileEntry& other) const noexcept {
         return (departureTime <= other.departureTime) && (normalizedPAT < other.normalizedPAT);
     }
@@ -42,6 +51,10 @@ public:
         return normalizedPAT - time * waitingCosts;
     }
 
+    inline PerceivedTime getNormalizedPAT() const noexcept {
+        return normalizedPAT;
+    }
+
     inline void print(const double waitingCosts) const noexcept {
         std::cout << "(" << departureTime << ", " << evaluate(departureTime, waitingCosts) << ", " << connectionId << ")" << std::endl;
     }
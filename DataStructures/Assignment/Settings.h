@@ -21,6 +21,11 @@ enum DepartureTimeChoice {
     DecisionModelWithBoxCox,
 };
 
+enum FootpathRelaxation {
+    PushFootpaths,
+    PullFootpaths
+};
+
 class Settings {
 
 public:
@@ -28,9 +33,12 @@ public:
     Settings(ConfigFile& config) {
         cycleMode = config.get("cycleMode", cycleMode);
         profilerType = config.get("profilerType", profilerType);
+        footpathRelaxation = config.get("footpathRelaxation", footpathRelaxation);
         randomSeed = config.get("randomSeed", randomSeed);
         passengerMultiplier = config.get("passengerMultiplier", passengerMultiplier);
         allowDepartureStops = config.get("allowDepartureStops", allowDepartureStops);
+        mergeEquivalentDestinations = config.get("mergeEquivalentDestinations", mergeEquivalentDestinations);
+        compactDemand = config.get("compactDemand", compactDemand);
         transferCosts = config.get("transferCosts", transferCosts);
         walkingCosts = config.get("walkingCosts", walkingCosts);
         waitingCosts = config.get("waitingCosts", waitingCosts);
@@ -39,6 +47,12 @@ public:
         delayTolerance = config.get("delayTolerance", delayTolerance);
         delayValue = config.get("delayValue", delayValue);
         maxDelay = config.get("maxDelay", maxDelay);
+        periodicTimetable = config.get("periodicTimetable", periodicTimetable);
+        periodicHorizon = config.get("periodicHorizon", periodicHorizon);
+        chAccessWalking = config.get("chAccessWalking", chAccessWalking);
+        maxAccessWalkingTime = config.get("maxAccessWalkingTime", maxAccessWalkingTime);
+        capacityIterations = config.get("capacityIterations", capacityIterations);
+        overloadPenalty = config.get("overloadPenalty", overloadPenalty);
         demandIntervalSplitTime = config.get("demandIntervalSplitTime", demandIntervalSplitTime);
         keepDemandIntervals = config.get("keepDemandIntervals", keepDemandIntervals);
         includeIntervalBorder = config.get("includeIntervalBorder", includeIntervalBorder);
@@ -50,13 +64,18 @@ public:
         adaptationLambda = config.get("adaptationLambda", adaptationLambda);
     }
 
+    // Contains exactly the settings, regardless of the current content of the file.
     ConfigFile toConfigFile(const std::string& fileName) const noexcept {
-        ConfigFile config(fileName);
+        ConfigFile config(fileName, false);
+        config.clear();
         config.set("cycleMode", cycleMode);
         config.set("profilerType", profilerType);
+        config.set("footpathRelaxation", footpathRelaxation);
         config.set("randomSeed", randomSeed);
         config.set("passengerMultiplier", passengerMultiplier);
         config.set("allowDepartureStops", allowDepartureStops);
+        config.set("mergeEquivalentDestinations", mergeEquivalentDestinations);
+        config.set("compactDemand", compactDemand);
         config.set("transferCosts", transferCosts);
         config.set("walkingCosts", walkingCosts);
         config.set("waitingCosts", waitingCosts);
@@ -65,6 +84,12 @@ public:
         config.set("delayTolerance", delayTolerance);
         config.set("delayValue", delayValue);
         config.set("maxDelay", maxDelay);
+        config.set("periodicTimetable", periodicTimetable);
+        config.set("periodicHorizon", periodicHorizon);
+        config.set("chAccessWalking", chAccessWalking);
+        config.set("maxAccessWalkingTime", maxAccessWalkingTime);
+        config.set("capacityIterations", capacityIterations);
+        config.set("overloadPenalty", overloadPenalty);
         config.set("demandIntervalSplitTime", demandIntervalSplitTime);
         config.set("keepDemandIntervals", keepDemandIntervals);
         config.set("includeIntervalBorder", includeIntervalBorder);
@@ -77,12 +102,24 @@ public:
         return config;
     }
 
+    // The PATs depend only on these settings (and on the use of transfer buffer times).
+    inline bool hasSamePATs(const Settings& other) const noexcept {
+        return (transferCosts == other.transferCosts) && (walkingCosts == other.walkingCosts) && (waitingCosts == other.waitingCosts) && (maxDelay == other.maxDelay) && (periodicTimetable == other.periodicTimetable) && (!periodicTimetable || (periodicHorizon == other.periodicHorizon)) && (chAccessWalking == other.chAccessWalking) && (!chAccessWalking || (maxAccessWalkingTime == other.maxAccessWalkingTime));
+    }
+
+    inline bool hasSameDemand(const Settings& other) const noexcept {
+        return (allowDepartureStops == other.allowDepartureStops) && (mergeEquivalentDestinations == other.mergeEquivalentDestinations) && (demandIntervalSplitTime == other.demandIntervalSplitTime) && (keepDemandIntervals == other.keepDemandIntervals) && (includeIntervalBorder == other.includeIntervalBorder);
+    }
+
     int cycleMode{RemoveStationCycles}; // Cycle removal (CycleMode)
     int profilerType{0}; // 0 = NoProfiler, 1 = TimeProfiler, 2 = DecisionProfiler
+    int footpathRelaxation{PushFootpaths}; // PAT computation: push entries to the profiles of nearby stops or pull them on evaluation (FootpathRelaxation, same results)
 
     int randomSeed{42}; // random seed of the Monte Carlo simulation
     int passengerMultiplier{100}; // multiplier for the demand
     bool allowDepartureStops{true}; // Can demand use stops as origins?
+    bool mergeEquivalentDestinations{false}; // Compute the PATs only once for destinations that are connected to the same stops with the same transfer times
+    bool compactDemand{false}; // Assign demand entries with the same destination, departure window and stop access of the origin as a single group
 
     int transferCosts{5 * 60}; // PAT overhead for changing vehicles
     double walkingCosts{2.0}; // cost factor for the walking time in the PAT (must be >= 0, walking is counted 1 + walkingCosts times)
@@ -95,6 +132,15 @@ public:
 
     int maxDelay{0}; // max delay of vehicles in the MEAT model
 
+    bool periodicTimetable{false}; // The timetable repeats every 24 hours, so journeys can continue on the next day (loads of the next day are added to the original connections)
+    int periodicHorizon{24 * 60 * 60}; // Periodic timetable: only connections departing within this time after the start of the next day are repeated
+
+    bool chAccessWalking{false}; // Walk between zones and stops along shortest paths of the transfer graph (CH bucket queries) instead of using only its direct edges
+    int maxAccessWalkingTime{-1}; // CH access walking: max walking time between a zone and a stop (negative value indicates no limit)
+
+    int capacityIterations{0}; // maximum number of reassignments with penalties for connections that exceed the trip capacity (0 = ignore capacities)
+    double overloadPenalty{10 * 60}; // PAT penalty that is added per iteration to an overloaded connection, multiplied by the relative overload
+
     int demandIntervalSplitTime{86400}; // Time interval size for discretization of the demand input time intervals (negative value indicates no discretization)
     bool keepDemandIntervals{true}; // false = collapse demand departure time intervals to their minimal value, true = keep full intervals
     bool includeIntervalBorder{false}; // true = intervals before discretization are interpreted as (min <= x <= max), false intervals before discretization are interpreted as (min <= x < max)
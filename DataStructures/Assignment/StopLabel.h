@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -64,6 +65,11 @@ public:
     }
 
     inline PerceivedTime evaluateWithDelay(const int time, const int maxDelay, const double waitingCosts) const noexcept {
+        return evaluateWithDelay(transferProfile, time, maxDelay, waitingCosts);
+    }
+
+    // Expected PAT of a transfer profile (a Pareto front with sentinel, see addTransferEntry) for an arrival at the given time.
+    inline static PerceivedTime evaluateWithDelay(const Profile& transferProfile, const int time, const int maxDelay, const double waitingCosts) noexcept {
         PerceivedTime pat = 0.0;
         double probability = 0.0;
         for (size_t i = transferProfile.size() - 1; i > 0; i--) {
@@ -82,6 +88,20 @@ public:
         return pat;
     }
 
+    // Same as above for a transfer profile given as unordered candidates, which may contain dominated entries. The front
+    // is used as buffer for the Pareto front of the candidates.
+    inline static PerceivedTime evaluateWithDelay(std::vector<ProfileEntry>& candidates, Profile& front, const int time, const int maxDelay, const double waitingCosts) noexcept {
+        std::sort(candidates.begin(), candidates.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+            return (a.departureTime > b.departureTime) || ((a.departureTime == b.departureTime) && !b.patDominates(a));
+        });
+        front.assign(1, ProfileEntry());
+        for (const ProfileEntry& entry : candidates) {
+            if (front.back().patDominates(entry)) continue;
+            front.emplace_back(entry);
+        }
+        return evaluateWithDelay(front, time, maxDelay, waitingCosts);
+    }
+
     inline const ProfileEntry& getSkipEntry() const noexcept {
         AssertMsg(!waitingProfile.empty(), "Missing sentinel entry!");
         return waitingProfile.back();
@@ -98,6 +118,12 @@ public:
         return waitingProfile;
     }
 
+    template<typename ITERATOR>
+    inline void setWaitingProfile(const ITERATOR begin, const ITERATOR end) noexcept {
+        AssertMsg(begin != end, "Missing sentinel entry!");
+        waitingProfile.assign(begin, end);
+    }
+
 private:
     inline static double delayProbability(const double time, const double maxDelay) noexcept {
         if (time < 0) return 0.0;
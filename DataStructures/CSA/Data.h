@@ -1,15 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <memory>
 #include <vector>
 #include <string>
 #include <set>
+#include <unordered_map>
 
 #include "Entities/Connection.h"
 #include "Entities/Stop.h"
 #include "Entities/Trip.h"
 #include "Entities/Journey.h"
+#include "MappedData.h"
+#include "MappedTransferGraph.h"
 
 #include "../Intermediate/Data.h"
 #include "../Graph/Graph.h"
@@ -18,6 +24,8 @@
 #include "../../Helpers/IO/Serialization.h"
 #include "../../Helpers/IO/CSVData.h"
 #include "../../Helpers/IO/ParserCSV.h"
+#include "../../Helpers/IO/ParallelCSVReader.h"
+#include "../../Helpers/IO/CSVRewriter.h"
 #include "../../Helpers/String/String.h"
 #include "../../Helpers/String/TextFileUtils.h"
 #include "../../Helpers/Vector/Permutation.h"
@@ -26,7 +34,9 @@
 #include "../../Helpers/FileSystem/FileSystem.h"
 #include "../../Helpers/Ranges/Range.h"
 #include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/Container/MappedVector.h"
 #include "../../Algorithms/Dijkstra/Dijkstra.h"
+#include "../../Algorithms/Dijkstra/TransitiveEdges.h"
 
 namespace CSA {
 
@@ -62,20 +72,25 @@ public:
         for (const Intermediate::Stop& stop : inter.stops) {
             data.stopData.emplace_back(stop);
         }
+        std::vector<Connection> connections;
         for (const Intermediate::Trip& trip : inter.trips) {
             AssertMsg(!trip.stopEvents.empty(), "Intermediate data contains trip without any stop event!");
             for (size_t i = 1; i < trip.stopEvents.size(); i++) {
                 const Intermediate::StopEvent& from = trip.stopEvents[i - 1];
                 const Intermediate::StopEvent& to = trip.stopEvents[i];
-                data.connections.emplace_back(from.stopId, to.stopId, from.departureTime, to.arrivalTime, TripId(data.tripData.size()));
+                connections.emplace_back(from.stopId, to.stopId, from.departureTime, to.arrivalTime, TripId(data.tripData.size()));
             }
             data.tripData.emplace_back(trip);
         }
-        std::sort(data.connections.begin(), data.connections.end());
+        std::sort(connections.begin(), connections.end());
+        data.connections.assign(std::move(connections));
         Intermediate::TransferGraph transferGraph = inter.transferGraph;
         Graph::printInfo(transferGraph);
         transferGraph.printAnalysis();
-        Graph::move(std::move(transferGraph), data.transferGraph);
+        TransferGraph graph;
+        Graph::move(std::move(transferGraph), graph);
+        data.transferGraph.assign(std::move(graph));
+        data.rebuildHotArrays();
         return data;
     }
 
@@ -86,11 +101,14 @@ public:
         data.readConnections(fileNameBase);
         data.readTrips(fileNameBase);
         data.readTransfers<MAKE_BIDIRECTIONAL>(fileNameBase);
+        data.rebuildHotArrays();
         return data;
     }
 
+    // The transitive transfer graph only contains edges with a travel time of at most maxWalkingTime and at most
+    // maxEdgesPerVertex outgoing edges per vertex (the shortest ones).
     template<bool MAKE_BIDIRECTIONAL = true>
-    inline static Data FromCSVwithZones(const std::string& fileNameBase) noexcept {
+    inline static Data FromCSVwithZones(const std::string& fileNameBase, const int maxWalkingTime = intMax, const size_t maxEdgesPerVertex = -1) noexcept {
         Data data;
         data.readStops(fileNameBase);
         data.readConnections(fileNameBase);
@@ -98,14 +116,13 @@ public:
         data.readTransfers<MAKE_BIDIRECTIONAL>(fileNameBase);
         data.readZones(fileNameBase);
         data.readZoneTransfers(fileNameBase);
-        data.makeDirectedTransitiveStopGraph();
+        data.makeDirectedTransitiveStopGraph(false, maxWalkingTime, maxEdgesPerVertex);
         return data;
     }
 
     inline static void RepairFiles(const std::string& fileNameBase) noexcept {
         RepairFileNames(fileNameBase);
-        RepairHeaders(fileNameBase);
-        RepairIDs(fileNameBase);
+        RepairHeadersAndIDs(fileNameBase);
     }
 
     inline static void RepairFileNames(const std::string& fileNameBase) noexcept {
@@ -118,172 +135,86 @@ public:
         for (size_t i = 1; i < demandFileNameAliases.size(); i++) FileSystem::renameFile(fileNameBase + demandFileNameAliases[i], fileNameBase + demandFileNameAliases.front());
     }
 
-    inline static void RepairHeaders(const std::string& fileNameBase) noexcept {
-        std::string stops = TextFile::read(fileNameBase + stopFileNameAliases.front());
-        stops = String::replaceAll(stops, "STOPNO[-]", "stop_id");
-        stops = String::replaceAll(stops, "TRANSFERTIME", "change_time");
-        stops = String::replaceAll(stops, "TRANSFERTIME[SEC]", "change_time");
-        stops = String::replaceAll(stops, "NAME[-]", "name");
-        stops = String::replaceAll(stops, "XCOORD[-]", "lon");
-        stops = String::replaceAll(stops, "YCOORD[-]", "lat");
-        TextFile::write(fileNameBase + stopFileNameAliases.front(), stops);
-        std::string connections = TextFile::read(fileNameBase + connectionFileNameAliases.front());
-        connections = String::replaceAll(connections, "FROMSTOPNO[-]", "dep_stop");
-        connections = String::replaceAll(connections, "TOSTOPNO[-]", "arr_stop");
-        connections = String::replaceAll(connections, "DEPARTURE[SEC]", "dep_time");
-        connections = String::replaceAll(connections, "ARRIVAL[SEC]", "arr_time");
-        connections = String::replaceAll(connections, "TRIP_ID[-]", "trip_id");
-        TextFile::write(fileNameBase + connectionFileNameAliases.front(), connections);
-        std::string trips = TextFile::read(fileNameBase + tripFileNameAliases.front());
-        trips = String::replaceAll(trips, "TRIP_NO[-]", "trip_id");
-        trips = String::replaceAll(trips, "LINE_NAME[-]", "name");
-        trips = String::replaceAll(trips, "T_SYS_CODE[-]", "vehicle");
-        trips = String::replaceAll(trips, "LINE_ROUTE_NAME[-]", "line_id");
-        trips = String::replaceAll(trips, "CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMBNO", "vehicle_type");
-        trips = String::replaceAll(trips, "CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMB\\SEATCAP", "seat_cap");
-        trips = String::replaceAll(trips, "CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMB\\TOTALCAP", "total_cap");
-        TextFile::write(fileNameBase + tripFileNameAliases.front(), trips);
-        std::string transfers = TextFile::read(fileNameBase + transferFileNameAliases.front());
-        transfers = String::replaceAll(transfers, "FROMSTOPNO[-]", "dep_stop");
-        transfers = String::replaceAll(transfers, "TOSTOPNO[-]", "arr_stop");
-        transfers = String::replaceAll(transfers, "DURATION[SEC]", "duration");
-        TextFile::write(fileNameBase + transferFileNameAliases.front(), transfers);
-        std::string zones = TextFile::read(fileNameBase + zoneFileNameAliases.front());
-        zones = String::replaceAll(zones, "NO[-]", "zone_id");
-        zones = String::replaceAll(zones, "XCOORD[-]", "lon");
-        zones = String::replaceAll(zones, "YCOORD[-]", "lat");
-        TextFile::write(fileNameBase + zoneFileNameAliases.front(), zones);
-        std::string zoneTransfers = TextFile::read(fileNameBase + zoneTransferFileNameAliases.front());
-        zoneTransfers = String::replaceAll(zoneTransfers, "FROMZONENO[-]", "zone_id");
-        zoneTransfers = String::replaceAll(zoneTransfers, "TOSTOPNO[-]", "stop_id");
-        zoneTransfers = String::replaceAll(zoneTransfers, "DURATION[SEC]", "duration");
-        TextFile::write(fileNameBase + zoneTransferFileNameAliases.front(), zoneTransfers);
-        std::string demand = TextFile::read(fileNameBase + demandFileNameAliases.front());
-        demand = String::replaceAll(demand, "FROMZONENO[-]", "dep_zone");
-        demand = String::replaceAll(demand, "TOZONENO[-]", "arr_zone");
-        demand = String::replaceAll(demand, "MINDEPARTURE[SEC]", "min_dep_time");
-        demand = String::replaceAll(demand, "MAXDEPARTURE[SEC]", "max_dep_time");
-        demand = String::replaceAll(demand, "DEMAND[-]", "passenger_count");
-        TextFile::write(fileNameBase + demandFileNameAliases.front(), demand);
-    }
-
-    inline static void RepairIDs(const std::string& fileNameBase) noexcept {
-        Map<std::string, std::string> stopIDs;
-        Map<std::string, std::string> tripIDs;
-        Map<std::string, std::string> zoneIDs;
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> stops(fileNameBase + stopFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> connections(fileNameBase + connectionFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> trips(fileNameBase + tripFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> transfers(fileNameBase + transferFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> zones(fileNameBase + zoneFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> zoneTransfers(fileNameBase + zoneTransferFileNameAliases.front());
-        IO::CSVData<std::string, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> demand(fileNameBase + demandFileNameAliases.front());
-        for (size_t line = 0; line < stops.getColumn("stop_id").size(); line++) {
-            std::string& stopID = stops.getColumn("stop_id")[line];
-            if (stopIDs.contains(stopID)) {
-                error("Repeated stop ID in line " + std::to_string(line) + " of stops: " + stopID + " = " + stopIDs[stopID] + "!");
-            } else {
-                stopIDs.insert(stopID, std::to_string(stopIDs.size()));
-            }
-            stopID = stopIDs[stopID];
-        }
-        for (size_t line = 0; line < trips.getColumn("trip_id").size(); line++) {
-            std::string& tripID = trips.getColumn("trip_id")[line];
-            if (tripIDs.contains(tripID)) {
-                error("Repeated trip ID in line " + std::to_string(line) + " of trips: " + tripID + " = " + tripIDs[tripID] + "!");
-            } else {
-                tripIDs.insert(tripID, std::to_string(tripIDs.size()));
-            }
-            tripID = tripIDs[tripID];
-        }
-        for (size_t line = 0; line < zones.getColumn("zone_id").size(); line++) {
-            std::string& zoneID = zones.getColumn("zone_id")[line];
-            if (zoneIDs.contains(zoneID)) {
-                error("Repeated zone ID in line " + std::to_string(line) + " of zones: " + zoneID + " = " + zoneIDs[zoneID] + "!");
-            } else {
-                zoneIDs.insert(zoneID, std::to_string(zoneIDs.size()));
-            }
-            zoneID = zoneIDs[zoneID];
-        }
-        for (size_t line = 0; line < connections.getColumn("dep_stop").size(); line++) {
-            std::string& stopID = connections.getColumn("dep_stop")[line];
-            if (stopIDs.contains(stopID)) {
-                stopID = stopIDs[stopID];
-            } else {
-                error("Unknown departure stop ID in line " + std::to_string(line) + " of connections: " + stopID + "!");
-            }
-        }
-        for (size_t line = 0; line < connections.getColumn("arr_stop").size(); line++) {
-            std::string& stopID = connections.getColumn("arr_stop")[line];
-            if (stopIDs.contains(stopID)) {
-                stopID = stopIDs[stopID];
-            } else {
-                error("Unknown arrival stop ID in line " + std::to_string(line) + " of connections: " + stopID + "!");
-            }
-        }
-        for (size_t line = 0; line < transfers.getColumn("dep_stop").size(); line++) {
-            std::string& stopID = transfers.getColumn("dep_stop")[line];
-            if (stopIDs.contains(stopID)) {
-                stopID = stopIDs[stopID];
-            } else {
-                error("Unknown departure stop ID in line " + std::to_string(line) + " of transfers: " + stopID + "!");
-            }
-        }
-        for (size_t line = 0; line < transfers.getColumn("arr_stop").size(); line++) {
-            std::string& stopID = transfers.getColumn("arr_stop")[line];
-            if (stopIDs.contains(stopID)) {
-                stopID = stopIDs[stopID];
-            } else {
-                error("Unknown arrival stop ID in line " + std::to_string(line) + " of transfers: " + stopID + "!");
-            }
-        }
-        for (size_t line = 0; line < zoneTransfers.getColumn("stop_id").size(); line++) {
-            std::string& stopID = zoneTransfers.getColumn("stop_id")[line];
-            if (stopIDs.contains(stopID)) {
-                stopID = stopIDs[stopID];
-            } else {
-                error("Unknown stop ID in line " + std::to_string(line) + " of zone transfers: " + stopID + "!");
-            }
-        }
-        for (size_t line = 0; line < connections.getColumn("trip_id").size(); line++) {
-            std::string& tripID = connections.getColumn("trip_id")[line];
-            if (tripIDs.contains(tripID)) {
-                tripID = tripIDs[tripID];
-            } else {
-                error("Unknown trip ID in line " + std::to_string(line) + " of connections: " + tripID + "!");
-            }
-        }
-        for (size_t line = 0; line < zoneTransfers.getColumn("zone_id").size(); line++) {
-            std::string& zoneID = zoneTransfers.getColumn("zone_id")[line];
-            if (zoneIDs.contains(zoneID)) {
-                zoneID = zoneIDs[zoneID];
-            } else {
-                error("Unknown zone ID in line " + std::to_string(line) + " of zone transfers: " + zoneID + "!");
-            }
-        }
-        for (size_t line = 0; line < demand.getColumn("dep_zone").size(); line++) {
-            std::string& zoneID = demand.getColumn("dep_zone")[line];
-            if (zoneIDs.contains(zoneID)) {
-                zoneID = zoneIDs[zoneID];
-            } else {
-                error("Unknown departure zone ID in line " + std::to_string(line) + " of demand: " + zoneID + "!");
-            }
-        }
-        for (size_t line = 0; line < demand.getColumn("arr_zone").size(); line++) {
-            std::string& zoneID = demand.getColumn("arr_zone")[line];
-            if (zoneIDs.contains(zoneID)) {
-                zoneID = zoneIDs[zoneID];
-            } else {
-                error("Unknown arrival zone ID in line " + std::to_string(line) + " of demand: " + zoneID + "!");
-            }
-        }
-        stops.write(fileNameBase + stopFileNameAliases.front());
-        connections.write(fileNameBase + connectionFileNameAliases.front());
-        trips.write(fileNameBase + tripFileNameAliases.front());
-        transfers.write(fileNameBase + transferFileNameAliases.front());
-        zones.write(fileNameBase + zoneFileNameAliases.front());
-        zoneTransfers.write(fileNameBase + zoneTransferFileNameAliases.front());
-        demand.write(fileNameBase + demandFileNameAliases.front());
+    // Renames the columns of the Visum export to the names expected by the parser and replaces the stop, trip and zone IDs
+    // by consecutive integers. Every file is rewritten in a single streaming pass.
+    inline static void RepairHeadersAndIDs(const std::string& fileNameBase) noexcept {
+        using CSVRewriter = IO::CSVRewriter<IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>>;
+        std::unordered_map<std::string, size_t> stopIDs;
+        std::unordered_map<std::string, size_t> tripIDs;
+        std::unordered_map<std::string, size_t> zoneIDs;
+        const auto assignID = [](std::unordered_map<std::string, size_t>& ids, const std::string& type) {
+            return [&ids, type](const std::string& id, const size_t line) {
+                const auto [entry, isNew] = ids.try_emplace(id, ids.size());
+                if (!isNew) error("Repeated " + type + " ID in line " + std::to_string(line) + " of " + type + "s: " + id + " = " + std::to_string(entry->second) + "!");
+                return std::to_string(entry->second);
+            };
+        };
+        const auto replaceID = [](const std::unordered_map<std::string, size_t>& ids, const std::string& type, const std::string& file) {
+            return [&ids, type, file](const std::string& id, const size_t line) {
+                const auto entry = ids.find(id);
+                if (entry != ids.end()) return std::to_string(entry->second);
+                error("Unknown " + type + " ID in line " + std::to_string(line) + " of " + file + ": " + id + "!");
+                return id;
+            };
+        };
+        CSVRewriter(fileNameBase + stopFileNameAliases.front())
+            .renameColumn("STOPNO[-]", "stop_id")
+            .renameColumn("TRANSFERTIME", "change_time")
+            .renameColumn("TRANSFERTIME[SEC]", "change_time")
+            .renameColumn("NAME[-]", "name")
+            .renameColumn("XCOORD[-]", "lon")
+            .renameColumn("YCOORD[-]", "lat")
+            .replaceValues("stop_id", assignID(stopIDs, "stop"))
+            .run();
+        CSVRewriter(fileNameBase + tripFileNameAliases.front())
+            .renameColumn("TRIP_NO[-]", "trip_id")
+            .renameColumn("LINE_NAME[-]", "name")
+            .renameColumn("T_SYS_CODE[-]", "vehicle")
+            .renameColumn("LINE_ROUTE_NAME[-]", "line_id")
+            .renameColumn("CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMBNO", "vehicle_type")
+            .renameColumn("CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMB\\SEATCAP", "seat_cap")
+            .renameColumn("CONCATENATE:VEHJOURNEYSECTIONS\\VEHCOMB\\TOTALCAP", "total_cap")
+            .replaceValues("trip_id", assignID(tripIDs, "trip"))
+            .run();
+        CSVRewriter(fileNameBase + zoneFileNameAliases.front())
+            .renameColumn("NO[-]", "zone_id")
+            .renameColumn("XCOORD[-]", "lon")
+            .renameColumn("YCOORD[-]", "lat")
+            .replaceValues("zone_id", assignID(zoneIDs, "zone"))
+            .run();
+        CSVRewriter(fileNameBase + connectionFileNameAliases.front())
+            .renameColumn("FROMSTOPNO[-]", "dep_stop")
+            .renameColumn("TOSTOPNO[-]", "arr_stop")
+            .renameColumn("DEPARTURE[SEC]", "dep_time")
+            .renameColumn("ARRIVAL[SEC]", "arr_time")
+            .renameColumn("TRIP_ID[-]", "trip_id")
+            .replaceValues("dep_stop", replaceID(stopIDs, "departure stop", "connections"))
+            .replaceValues("arr_stop", replaceID(stopIDs, "arrival stop", "connections"))
+            .replaceValues("trip_id", replaceID(tripIDs, "trip", "connections"))
+            .run();
+        CSVRewriter(fileNameBase + transferFileNameAliases.front())
+            .renameColumn("FROMSTOPNO[-]", "dep_stop")
+            .renameColumn("TOSTOPNO[-]", "arr_stop")
+            .renameColumn("DURATION[SEC]", "duration")
+            .replaceValues("dep_stop", replaceID(stopIDs, "departure stop", "transfers"))
+            .replaceValues("arr_stop", replaceID(stopIDs, "arrival stop", "transfers"))
+            .run();
+        CSVRewriter(fileNameBase + zoneTransferFileNameAliases.front())
+            .renameColumn("FROMZONENO[-]", "zone_id")
+            .renameColumn("TOSTOPNO[-]", "stop_id")
+            .renameColumn("DURATION[SEC]", "duration")
+            .replaceValues("zone_id", replaceID(zoneIDs, "zone", "zone transfers"))
+            .replaceValues("stop_id", replaceID(stopIDs, "stop", "zone transfers"))
+            .run();
+        CSVRewriter(fileNameBase + demandFileNameAliases.front())
+            .renameColumn("FROMZONENO[-]", "dep_zone")
+            .renameColumn("TOZONENO[-]", "arr_zone")
+            .renameColumn("MINDEPARTURE[SEC]", "min_dep_time")
+            .renameColumn("MAXDEPARTURE[SEC]", "max_dep_time")
+            .renameColumn("DEMAND[-]", "passenger_count")
+            .replaceValues("dep_zone", replaceID(zoneIDs, "departure zone", "demand"))
+            .replaceValues("arr_zone", replaceID(zoneIDs, "arrival zone", "demand"))
+            .run();
     }
 
     template<bool MAKE_BIDIRECTIONAL = true, typename GRAPH_TYPE>
@@ -292,19 +223,24 @@ public:
         Data data;
         data.stopData = stops;
         data.tripData = trips;
+        std::vector<Connection> validConnections;
         for (const Connection con : connections) {
             if (con.departureStopId >= data.stopData.size() || data.stopData[con.departureStopId].minTransferTime < 0) continue;
             if (con.arrivalStopId >= data.stopData.size() || data.stopData[con.arrivalStopId].minTransferTime < 0) continue;
             if (con.departureTime > con.arrivalTime) continue;
             if (con.tripId >= data.tripData.size()) continue;
-            data.connections.emplace_back(con);
+            validConnections.emplace_back(con);
         }
+        data.connections.assign(std::move(validConnections));
         Intermediate::TransferGraph graph;
         Graph::move(std::move(transferGraph), graph);
         if constexpr (MAKE_BIDIRECTIONAL) graph.makeBidirectional();
         graph.reduceMultiEdgesBy(TravelTime);
         graph.packEdges();
-        Graph::move(std::move(graph), data.transferGraph);
+        TransferGraph staticGraph;
+        Graph::move(std::move(graph), staticGraph);
+        data.transferGraph.assign(std::move(staticGraph));
+        data.rebuildHotArrays();
         return data;
     }
 
@@ -327,18 +263,21 @@ protected:
 
     inline void readConnections(const std::string& fileNameBase, const bool verbose = true) {
         IO::readFile(connectionFileNameAliases, "Connections", [&](){
-            size_t count = 0;
-            IO::CSVReader<5, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + connectionFileNameAliases);
+            IO::ParallelCSVReader<5, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + connectionFileNameAliases);
             in.readHeader("dep_stop", "arr_stop", "dep_time", "arr_time", "trip_id");
-            Connection con;
-            while (in.readRow(con.departureStopId, con.arrivalStopId, con.departureTime, con.arrivalTime, con.tripId)) {
-                if (con.departureStopId >= stopData.size() || stopData[con.departureStopId].minTransferTime < 0) continue;
-                if (con.arrivalStopId >= stopData.size() || stopData[con.arrivalStopId].minTransferTime < 0) continue;
-                if (con.tripId >= tripData.size()) tripData.resize(con.tripId + 1, Trip("NOT_NAMED", "NOT_NAMED", -2));
-                connections.emplace_back(con);
-                count++;
-            }
-            return count;
+            const std::vector<Connection> newConnections = in.readRows<Connection>([&](const auto& row, Connection& con) {
+                row.parse(con.departureStopId, con.arrivalStopId, con.departureTime, con.arrivalTime, con.tripId);
+                if (con.departureStopId >= stopData.size() || stopData[con.departureStopId].minTransferTime < 0) return false;
+                if (con.arrivalStopId >= stopData.size() || stopData[con.arrivalStopId].minTransferTime < 0) return false;
+                return true;
+            });
+            connections.modify([&](std::vector<Connection>& connectionList) {
+                for (const Connection& con : newConnections) {
+                    if (con.tripId >= tripData.size()) tripData.resize(con.tripId + 1, Trip("NOT_NAMED", "NOT_NAMED", -2));
+                    connectionList.emplace_back(con);
+                }
+            });
+            return newConnections.size();
         }, verbose);
         sanitizeConnections();
     }
@@ -346,15 +285,17 @@ protected:
     inline void readTrips(const std::string& fileNameBase, const bool verbose = true) {
         IO::readFile(tripFileNameAliases, "Trips", [&](){
             size_t count = 0;
-            IO::CSVReader<4, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + tripFileNameAliases);
-            in.readHeader(IO::IGNORE_EXTRA_COLUMN | IO::IGNORE_MISSING_COLUMN, "trip_id", "name", "vehicle", "line_id");
+            IO::CSVReader<6, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + tripFileNameAliases);
+            in.readHeader(IO::IGNORE_EXTRA_COLUMN | IO::IGNORE_MISSING_COLUMN, "trip_id", "name", "vehicle", "line_id", "total_cap", "seat_cap");
             TripId tripID;
             std::string tripName = "NOT_NAMED";
             std::string type = "train";
             std::string route = "NOT_NAMED";
-            while (in.readRow(tripID, tripName, type, route)) {
+            int totalCapacity = -1;
+            int seatCapacity = -1;
+            while (in.readRow(tripID, tripName, type, route, totalCapacity, seatCapacity)) {
                 if (tripID >= tripData.size()) continue;
-                tripData[tripID] = Trip(tripName, route, GTFS::Type::Rail);
+                tripData[tripID] = Trip(tripName, route, GTFS::Type::Rail, (totalCapacity >= 0) ? totalCapacity : seatCapacity);
                 type = String::toLower(type);
                 if (type == "b") tripData[tripID].type = GTFS::Type::Bus;
                 if (type == "bus") tripData[tripID].type = GTFS::Type::Bus;
@@ -388,10 +329,12 @@ protected:
         if (tripCount < tripData.size()) {
             permutation.permutate(tripData);
             tripData.resize(tripCount);
-            for (Connection& con : connections) {
-                con.tripId = permutation.permutate(con.tripId);
-                AssertMsg(con.tripId < tripCount, "Connection belongs to trip without trip data! (" << con << ", number of trips: " << tripCount << ")");
-            }
+            connections.modify([&](std::vector<Connection>& connectionList) {
+                for (Connection& con : connectionList) {
+                    con.tripId = permutation.permutate(con.tripId);
+                    AssertMsg(con.tripId < tripCount, "Connection belongs to trip without trip data! (" << con << ", number of trips: " << tripCount << ")");
+                }
+            });
         }
     }
 
@@ -410,13 +353,14 @@ protected:
             prunedConnections.emplace_back(current);
         }
         std::cout << "Pruned " << connections.size() - prunedConnections.size() << " connections" << std::endl;
-        connections = prunedConnections;
+        connections.assign(std::move(prunedConnections));
     }
 
     template<bool MAKE_BIDIRECTIONAL = true>
     inline void readTransfers(const std::string& fileNameBase, const bool verbose = true) {
-        Intermediate::TransferGraph graph;
+        TransferGraph graph;
         graph.addVertices(stopData.size());
+        std::vector<TransferGraph::BufferedEdge> edges;
         for (const Vertex vertex : graph.vertices()) {
             graph.set(Coordinates, vertex, stopData[vertex].coordinates);
         }
@@ -433,38 +377,44 @@ protected:
                 if (from == to && isStop(from)) {
                     stopData[from].minTransferTime = std::max(stopData[from].minTransferTime, travelTime);
                 } else {
-                    graph.addEdge(from, to).set(TravelTime, travelTime);
-                    if constexpr (MAKE_BIDIRECTIONAL) graph.addEdge(to, from).set(TravelTime, travelTime);
+                    edges.emplace_back(TransferGraph::BufferedEdge{from, to, TransferGraph::EdgeRecord(travelTime)});
+                    if constexpr (MAKE_BIDIRECTIONAL) edges.emplace_back(TransferGraph::BufferedEdge{to, from, TransferGraph::EdgeRecord(travelTime)});
                 }
                 count++;
             }
             return count;
         }, verbose);
+        graph.assignEdges(edges);
         graph.reduceMultiEdgesBy(TravelTime);
-        graph.packEdges();
-        Graph::move(std::move(graph), transferGraph);
+        transferGraph.assign(std::move(graph));
     }
 
     inline void readZones(const std::string& fileNameBase, const bool verbose = true) {
-        IO::readFile(zoneFileNameAliases, "Zones", [&](){
-            size_t count = 0;
-            IO::CSVReader<3, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + zoneFileNameAliases);
-            in.readHeader("zone_id", "lon", "lat");
-            Vertex zoneID;
-            Geometry::Point coordinates;
-            while (in.readRow(zoneID, coordinates.longitude, coordinates.latitude)) {
-                zoneID += stopData.size();
-                transferGraph.addVertices(zoneID - transferGraph.numVertices() + 1);
-                transferGraph.set(Coordinates, zoneID, coordinates);
-                count++;
-            }
-            return count;
-        }, verbose);
+        transferGraph.modify([&](TransferGraph& graph) {
+            IO::readFile(zoneFileNameAliases, "Zones", [&](){
+                size_t count = 0;
+                IO::CSVReader<3, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + zoneFileNameAliases);
+                in.readHeader("zone_id", "lon", "lat");
+                Vertex zoneID;
+                Geometry::Point coordinates;
+                while (in.readRow(zoneID, coordinates.longitude, coordinates.latitude)) {
+                    zoneID += stopData.size();
+                    graph.addVertices(zoneID - graph.numVertices() + 1);
+                    graph.set(Coordinates, zoneID, coordinates);
+                    count++;
+                }
+                return count;
+            }, verbose);
+        });
     }
 
     inline void readZoneTransfers(const std::string& fileNameBase, const bool verbose = true) {
-        Intermediate::TransferGraph graph;
-        Graph::move(std::move(transferGraph), graph);
+        std::vector<TransferGraph::BufferedEdge> edges;
+        for (const Vertex from : transferGraph.vertices()) {
+            for (const Edge edge : transferGraph.edgesFrom(from)) {
+                edges.emplace_back(TransferGraph::BufferedEdge{from, transferGraph.get(ToVertex, edge), TransferGraph::EdgeRecord(transferGraph.get(TravelTime, edge))});
+            }
+        }
         IO::readFile(zoneTransferFileNameAliases, "ZoneTransfers", [&](){
             size_t count = 0;
             IO::CSVReader<3, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(fileNameBase + zoneTransferFileNameAliases);
@@ -474,17 +424,18 @@ protected:
             int travelTime;
             while (in.readRow(zoneID, stopId, travelTime)) {
                 zoneID += stopData.size();
-                if (!graph.isVertex(zoneID)) continue;
-                if (!graph.isVertex(stopId) || stopData[stopId].minTransferTime == -1) continue;
-                graph.addEdge(zoneID, stopId).set(TravelTime, travelTime);
-                graph.addEdge(stopId, zoneID).set(TravelTime, travelTime);
+                if (!transferGraph.isVertex(zoneID)) continue;
+                if (!transferGraph.isVertex(stopId) || stopData[stopId].minTransferTime == -1) continue;
+                edges.emplace_back(TransferGraph::BufferedEdge{zoneID, stopId, TransferGraph::EdgeRecord(travelTime)});
+                edges.emplace_back(TransferGraph::BufferedEdge{stopId, zoneID, TransferGraph::EdgeRecord(travelTime)});
                 count++;
             }
             return count;
         }, verbose);
-        graph.reduceMultiEdgesBy(TravelTime);
-        graph.packEdges();
-        Graph::move(std::move(graph), transferGraph);
+        transferGraph.modify([&](TransferGraph& graph) {
+            graph.assignEdges(edges);
+            graph.reduceMultiEdgesBy(TravelTime);
+        });
     }
 
 public:
@@ -500,7 +451,14 @@ public:
     inline bool isConnection(const ConnectionId connectionId) const noexcept {return connectionId < numberOfConnections();}
     inline Range<ConnectionId> connectionIds() const noexcept {return Range<ConnectionId>(ConnectionId(0), ConnectionId(numberOfConnections()));}
 
-    inline int minTransferTime(const StopId stop) const noexcept {return stopData[stop].minTransferTime;}
+    inline const std::vector<Stop>& getStopData() const noexcept {return stopData;}
+    inline const std::vector<Trip>& getTripData() const noexcept {return tripData;}
+
+    inline int minTransferTime(const StopId stop) const noexcept {return stopMinTransferTime[stop];}
+    // Smallest stop id within the transfer graph neighborhood of the stop
+    inline StopId station(const StopId stop) const noexcept {return stationOfStop[stop];}
+    inline int tripType(const TripId trip) const noexcept {return typeOfTrip[trip];}
+    inline int tripCapacity(const TripId trip) const noexcept {return capacityOfTrip[trip];}
 
     inline Geometry::Rectangle boundingBox() const noexcept {
         Geometry::Rectangle result = Geometry::Rectangle::Empty();
@@ -511,42 +469,48 @@ public:
     }
 
     inline void sortConnectionsAscending() noexcept {
-        std::stable_sort(connections.begin(), connections.end());
+        sortConnections([](const Connection& a, const Connection& b){
+            return a < b;
+        });
     }
 
     inline void sortConnectionsDescending() noexcept {
-        std::stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        sortConnections([](const Connection& a, const Connection& b){
             return b < a;
         });
     }
 
     inline void sortConnectionsAscendingByDepartureTime() noexcept {
-        std::stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        sortConnections([](const Connection& a, const Connection& b){
             return a.departureTime < b.departureTime;
         });
     }
 
     inline void sortConnectionsAscendingByArrivalTime() noexcept {
-        std::stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        sortConnections([](const Connection& a, const Connection& b){
             return a.arrivalTime < b.arrivalTime;
         });
     }
 
     inline void sortConnectionsDescendingByDepartureTime() noexcept {
-        std::stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        sortConnections([](const Connection& a, const Connection& b){
             return a.departureTime > b.departureTime;
         });
     }
 
     inline void sortConnectionsDescendingByArrivalTime() noexcept {
-        std::stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        sortConnections([](const Connection& a, const Connection& b){
             return a.arrivalTime > b.arrivalTime;
         });
     }
 
     inline void sortUnique() noexcept {
-        std::sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b){
+        const auto less = [](const Connection& a, const Connection& b){
             return std::make_tuple(a.departureTime, a.arrivalTime, a.departureStopId, a.arrivalStopId, a.tripId) < std::make_tuple(b.departureTime, b.arrivalTime, b.departureStopId, b.arrivalStopId, b.tripId);
+        };
+        if (std::is_sorted(connections.begin(), connections.end(), less)) return;
+        connections.modify([&](std::vector<Connection>& connectionList) {
+            std::sort(connectionList.begin(), connectionList.end(), less);
         });
     }
 
@@ -598,89 +562,71 @@ public:
     }
 
 
-    inline void makeUndirectedTransitiveStopGraph(const bool verbose = false) noexcept {
-        Intermediate::TransferGraph graph;
-        graph.addVertices(transferGraph.numVertices());
-        for (const Vertex from : transferGraph.vertices()) {
-            graph.set(Coordinates, from, transferGraph.get(Coordinates, from));
-            for (const Edge edge : transferGraph.edgesFrom(from)) {
-                const Vertex to = transferGraph.get(ToVertex, edge);
+    inline void makeUndirectedTransitiveStopGraph(const bool verbose = false, const int maxWalkingTime = intMax, const size_t maxNeighbors = -1) noexcept {
+        transferGraph.modify([&](TransferGraph& graph) {
+            std::vector<TransferGraph::BufferedEdge> stopEdges;
+            for (const auto [edge, from] : graph.edgesWithFromVertex()) {
+                const Vertex to = graph.get(ToVertex, edge);
                 if (to >= stopData.size()) continue;
-                graph.addEdge(from, to).set(TravelTime, transferGraph.get(TravelTime, edge));
+                stopEdges.emplace_back(TransferGraph::BufferedEdge{from, to, graph.edgeRecord(edge)});
             }
-        }
-        graph.packEdges();
-        Graph::move(std::move(graph), transferGraph);
-        graph.clear();
-        graph.addVertices(transferGraph.numVertices());
-        Dijkstra<TransferGraph, false> dijkstra(transferGraph, transferGraph[TravelTime]);
-        Progress progress(transferGraph.numVertices(), verbose);
-        for (const Vertex v : transferGraph.vertices()) {
-            graph.set(Coordinates, v, transferGraph.get(Coordinates, v));
-            dijkstra.run(v, noVertex, [&](const Vertex u) {
+            graph.assignEdges(stopEdges);
+            std::vector<std::vector<TransferGraph::BufferedEdge>> buffers;
+            collectTransitiveEdges(graph, Vertex(0), Vertex(graph.numVertices()), buffers, [](const auto& dijkstra, const Vertex v, const Vertex u, std::vector<TransferGraph::BufferedEdge>& buffer) {
                 if (u >= v) return;
                 const int travelTime = dijkstra.getDistance(u);
-                graph.addEdge(v, u).set(TravelTime, travelTime);
-                graph.addEdge(u, v).set(TravelTime, travelTime);
-            });
-            progress++;
-        }
-        graph.packEdges();
-        Graph::move(std::move(graph), transferGraph);
+                buffer.emplace_back(TransferGraph::BufferedEdge{v, u, TransferGraph::EdgeRecord(travelTime)});
+                buffer.emplace_back(TransferGraph::BufferedEdge{u, v, TransferGraph::EdgeRecord(travelTime)});
+            }, verbose, maxWalkingTime, maxNeighbors);
+            graph.assignEdges(buffers);
+        });
+        rebuildHotArrays();
     }
 
-    inline void makeDirectedTransitiveStopGraph(const bool verbose = false) noexcept {
-        Intermediate::TransferGraph toZones;
-        Intermediate::TransferGraph fromZones;
-        Intermediate::TransferGraph newTransferGraph;
-        toZones.addVertices(transferGraph.numVertices());
-        fromZones.addVertices(transferGraph.numVertices());
-        newTransferGraph.addVertices(transferGraph.numVertices());
+    inline void makeDirectedTransitiveStopGraph(const bool verbose = false, const int maxWalkingTime = intMax, const size_t maxEdgesPerVertex = -1) noexcept {
+        std::vector<TransferGraph::BufferedEdge> toZoneEdges;
+        std::vector<TransferGraph::BufferedEdge> fromZoneEdges;
         for (const Vertex from : transferGraph.vertices()) {
-            newTransferGraph.set(Coordinates, from, transferGraph.get(Coordinates, from));
             for (const Edge edge : transferGraph.edgesFrom(from)) {
-                const Vertex to = transferGraph.get(ToVertex, edge);
-                const int travelTime = transferGraph.get(TravelTime, edge);
-                if (from < stopData.size()) toZones.addEdge(from, to).set(TravelTime, travelTime);
-                if (to < stopData.size()) fromZones.addEdge(from, to).set(TravelTime, travelTime);
+                const TransferGraph::BufferedEdge bufferedEdge{from, transferGraph.get(ToVertex, edge), TransferGraph::EdgeRecord(transferGraph.get(TravelTime, edge))};
+                if (from < stopData.size()) toZoneEdges.emplace_back(bufferedEdge);
+                if (bufferedEdge.to < stopData.size()) fromZoneEdges.emplace_back(bufferedEdge);
             }
         }
+        TransferGraph toZones;
+        TransferGraph fromZones;
+        const auto addEdge = [](const auto& dijkstra, const Vertex source, const Vertex u, std::vector<TransferGraph::BufferedEdge>& buffer) {
+            if (u != source) buffer.emplace_back(TransferGraph::BufferedEdge{source, u, TransferGraph::EdgeRecord(dijkstra.getDistance(u))});
+        };
+        std::vector<std::vector<TransferGraph::BufferedEdge>> buffers;
         if (stopData.size() > 0) {
-            toZones.packEdges();
-            Dijkstra<Intermediate::TransferGraph, false> dijkstra(toZones, toZones[TravelTime]);
-            Progress progress(stopData.size(), verbose);
-            for (const StopId stop : stops()) {
-                dijkstra.run(stop, noVertex, [&](const Vertex u) {
-                    if (u != stop) newTransferGraph.addEdge(stop, u).set(TravelTime, dijkstra.getDistance(u));
-                });
-                progress++;
-            }
+            toZones.addVertices(transferGraph.numVertices());
+            toZones.assignEdges(toZoneEdges);
+            collectTransitiveEdges(toZones, Vertex(0), Vertex(stopData.size()), buffers, addEdge, verbose, maxWalkingTime, maxEdgesPerVertex);
         }
         if (transferGraph.numVertices() > stopData.size()) {
-            fromZones.packEdges();
-            Dijkstra<Intermediate::TransferGraph, false> dijkstra(fromZones, fromZones[TravelTime]);
-            Progress progress(transferGraph.numVertices() - stopData.size(), verbose);
-            for (Vertex v = Vertex(stopData.size()); v < transferGraph.numVertices(); v++) {
-                dijkstra.run(v, noVertex, [&](const Vertex u) {
-                    if (u != v) newTransferGraph.addEdge(v, u).set(TravelTime, dijkstra.getDistance(u));
-                });
-                progress++;
-            }
+            fromZones.addVertices(transferGraph.numVertices());
+            fromZones.assignEdges(fromZoneEdges);
+            collectTransitiveEdges(fromZones, Vertex(stopData.size()), Vertex(transferGraph.numVertices()), buffers, addEdge, verbose, maxWalkingTime, maxEdgesPerVertex);
         }
-        Dijkstra<TransferGraph, false> dijkstraToZones(transferGraph, transferGraph[TravelTime]);
-        newTransferGraph.packEdges();
-        Graph::move(std::move(newTransferGraph), transferGraph);
+        transferGraph.modify([&](TransferGraph& graph) {
+            graph.assignEdges(buffers);
+        });
+        rebuildHotArrays();
     }
 
     inline void duplicateConnections(const int timeOffset = 24 * 60 * 60) noexcept {
         const size_t oldConnectionCount = connections.size();
         const size_t oldTripCount = tripData.size();
-        for (size_t i = 0; i < oldConnectionCount; i++) {
-            connections.emplace_back(connections[i], timeOffset, oldTripCount);
-        }
+        connections.modify([&](std::vector<Connection>& connectionList) {
+            for (size_t i = 0; i < oldConnectionCount; i++) {
+                connectionList.emplace_back(connectionList[i], timeOffset, oldTripCount);
+            }
+        });
         for (size_t i = 0; i < oldTripCount; i++) {
             tripData.emplace_back(tripData[i]);
         }
+        rebuildHotArrays();
     }
 
     inline std::vector<int> numberOfNeighborStopsByStop() const noexcept {
@@ -696,13 +642,15 @@ public:
     }
 
     inline void applyMinTravelTime(const double minTravelTime) noexcept {
-        for (const Vertex from : transferGraph.vertices()) {
-            for (const Edge edge : transferGraph.edgesFrom(from)) {
-                if (transferGraph.get(TravelTime, edge) < minTravelTime) {
-                    transferGraph.set(TravelTime, edge, minTravelTime);
+        transferGraph.modify([&](TransferGraph& graph) {
+            for (const Vertex from : graph.vertices()) {
+                for (const Edge edge : graph.edgesFrom(from)) {
+                    if (graph.get(TravelTime, edge) < minTravelTime) {
+                        graph.set(TravelTime, edge, minTravelTime);
+                    }
                 }
             }
-        }
+        });
     }
 
     inline void applyVertexPermutation(const Permutation& permutation, const bool permutateStops = true) noexcept {
@@ -730,7 +678,7 @@ public:
     }
 
 public:
-    inline const std::vector<Geometry::Point>& getCoordinates() const noexcept {
+    inline const MappedVector<Geometry::Point>& getCoordinates() const noexcept {
         return transferGraph[Coordinates];
     }
 
@@ -889,34 +837,154 @@ public:
     }
 
     inline void serialize(const std::string& fileName) const noexcept {
-        IO::serialize(fileName, connections, stopData, tripData);
-        transferGraph.writeBinary(fileName + ".graph");
+        IO::serialize(fileName, BinaryHeader(), connections, stopData, tripData);
+        transferGraph.toStaticGraph().writeBinary(fileName + ".graph");
+    }
+
+    // Writes the network in the format of MappedData, which is read by deserialize() as well.
+    inline void serializeMapped(const std::string& fileName) const noexcept {
+        MappedData::Write(fileName, connections, stopData, tripData, stationOfStop, transferGraph);
     }
 
     inline void deserialize(const std::string& fileName) noexcept {
-        IO::deserialize(fileName, connections, stopData, tripData);
-        transferGraph.readBinary(fileName + ".graph");
+        if (MappedData::IsMappedFile(fileName)) {
+            deserializeMapped(std::make_shared<const MappedData>(fileName));
+            return;
+        }
+        if (BinaryHeader::IsContainedIn(fileName)) {
+            BinaryHeader header;
+            IO::deserialize(fileName, header, connections, stopData, tripData);
+        } else {
+            // Binaries without header have format version 0, which does not contain the trip capacities
+            IO::deserialize(fileName, connections, stopData, tripData);
+        }
+        TransferGraph graph;
+        graph.readBinary(fileName + ".graph");
+        transferGraph.assign(std::move(graph));
+        rebuildHotArrays();
+    }
+
+    // Only the names are copied. The connections, the dense arrays and the transfer graph are views into the mapping,
+    // which is kept alive by the data and its copies, so processes that map the same file share these arrays.
+    inline void deserializeMapped(const std::shared_ptr<const MappedData>& mapping) noexcept {
+        mappedData = mapping;
+        connections.view(mappedData->connections(), mappedData->numberOfConnections());
+        stopData.clear();
+        stopData.reserve(mappedData->numberOfStops());
+        for (const StopId stop : Range<StopId>(StopId(0), StopId(mappedData->numberOfStops()))) {
+            stopData.emplace_back(std::string(mappedData->stopName(stop)), mappedData->stopCoordinates()[stop], mappedData->stopMinTransferTimes()[stop]);
+        }
+        tripData.clear();
+        tripData.reserve(mappedData->numberOfTrips());
+        for (const TripId trip : Range<TripId>(TripId(0), TripId(mappedData->numberOfTrips()))) {
+            tripData.emplace_back(std::string(mappedData->tripName(trip)), std::string(mappedData->routeName(trip)), mappedData->tripTypes()[trip], mappedData->tripCapacities()[trip]);
+        }
+        transferGraph.view(mappedData->beginOut(), mappedData->toVertices(), mappedData->travelTimes(), mappedData->vertexCoordinates(), mappedData->numberOfVertices(), mappedData->numberOfEdges());
+        stopMinTransferTime.view(mappedData->stopMinTransferTimes(), numberOfStops());
+        stationOfStop.view(mappedData->stopStations(), numberOfStops());
+        typeOfTrip.view(mappedData->tripTypes(), numberOfTrips());
+        capacityOfTrip.view(mappedData->tripCapacities(), numberOfTrips());
+    }
+
+    // The attributes that are read by the algorithms are kept in dense arrays, separate from the names in stopData and
+    // tripData. Has to be called after the transfer graph has been modified.
+    inline void rebuildHotArrays() noexcept {
+        std::vector<int> minTransferTimes(numberOfStops());
+        std::vector<StopId> stations(numberOfStops());
+        for (const StopId stop : stops()) {
+            minTransferTimes[stop] = stopData[stop].minTransferTime;
+            stations[stop] = stop;
+            if (!transferGraph.isVertex(stop)) continue;
+            for (const Edge edge : transferGraph.edgesFrom(stop)) {
+                stations[stop] = std::min<StopId>(stations[stop], StopId(transferGraph.get(ToVertex, edge)));
+            }
+        }
+        std::vector<int> types(numberOfTrips());
+        std::vector<int> capacities(numberOfTrips());
+        for (const TripId trip : tripIds()) {
+            types[trip] = tripData[trip].type;
+            capacities[trip] = tripData[trip].capacity;
+        }
+        stopMinTransferTime.assign(std::move(minTransferTimes));
+        stationOfStop.assign(std::move(stations));
+        typeOfTrip.assign(std::move(types));
+        capacityOfTrip.assign(std::move(capacities));
     }
 
 private:
+    // Magic number and format version that precede the data of a binary. The version is passed on to the entities,
+    // which choose their layout accordingly.
+    struct BinaryHeader {
+        inline static constexpr uint64_t Magic = 0x5952414E49425343ull; // "CSBINARY"
+        inline static constexpr size_t Version = 1;
+
+        inline static bool IsContainedIn(const std::string& fileName) noexcept {
+            std::ifstream in(fileName, std::ios::binary);
+            int fileHeader = 0;
+            uint64_t magic = 0;
+            in.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+            in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+            return in && fileHeader == IO::FileHeader && magic == Magic;
+        }
+
+        inline void serialize(IO::Serialization& serialize) const noexcept {
+            serialize(Magic, Version);
+            serialize.setFormatVersion(Version);
+        }
+
+        inline void deserialize(IO::Deserialization& deserialize) noexcept {
+            uint64_t magic = 0;
+            size_t version = 0;
+            deserialize(magic, version);
+            Ensure(magic == Magic, "The file " << deserialize.getFileName() << " is not a CSA binary!");
+            Ensure(version <= Version, "The file " << deserialize.getFileName() << " has format version " << version << ", but this build reads only versions up to " << Version << "!");
+            deserialize.setFormatVersion(version);
+        }
+    };
+
     inline void permutate(const Permutation& fullPermutation, const Permutation& stopPermutation) noexcept {
         AssertMsg(fullPermutation.size() == transferGraph.numVertices(), "Full permutation size (" << fullPermutation.size() << ") must be the same as number of vertices (" << transferGraph.numVertices() << ")!");
         AssertMsg(stopPermutation.size() == numberOfStops(), "Stop permutation size (" << stopPermutation.size() << ") must be the same as number of stops (" << numberOfStops() << ")!");
 
-        for (Connection& connection : connections) {
-            connection.applyStopPermutation(stopPermutation);
-        }
+        connections.modify([&](std::vector<Connection>& connectionList) {
+            for (Connection& connection : connectionList) {
+                connection.applyStopPermutation(stopPermutation);
+            }
+        });
         stopPermutation.permutate(stopData);
 
-        transferGraph.applyVertexPermutation(fullPermutation);
+        transferGraph.modify([&](TransferGraph& graph) {
+            graph.applyVertexPermutation(fullPermutation);
+        });
+        rebuildHotArrays();
+    }
+
+    // Keeps a view into a mapped file if the connections are sorted already.
+    template<typename LESS>
+    inline void sortConnections(const LESS& less) noexcept {
+        if (std::is_sorted(connections.begin(), connections.end(), less)) return;
+        connections.modify([&](std::vector<Connection>& connectionList) {
+            std::stable_sort(connectionList.begin(), connectionList.end(), less);
+        });
     }
 
 public:
-    std::vector<Connection> connections;
+    MappedVector<Connection> connections;
+
+    MappedTransferGraph transferGraph;
+
+private:
+    // Read-only outside of Data, since the dense arrays below are derived from them
     std::vector<Stop> stopData;
     std::vector<Trip> tripData;
 
-    TransferGraph transferGraph;
+    MappedVector<int> stopMinTransferTime;
+    MappedVector<StopId> stationOfStop;
+    MappedVector<int> typeOfTrip;
+    MappedVector<int> capacityOfTrip;
+
+    // Keeps the mapped file alive while the arrays above are views into it
+    std::shared_ptr<const MappedData> mappedData;
 
 };
 
@@ -7,26 +7,39 @@
 #include "../../GTFS/Entities/Vehicle.h"
 #include "../../Intermediate/Entities/Trip.h"
 
+#include "../../../Helpers/Meta.h"
 #include "../../../Helpers/IO/Serialization.h"
 
 namespace CSA {
 
+namespace ImplementationDetail {
+    template<typename T, typename = void>
+    struct HasCapacity : Meta::False {};
+
+    template<typename T>
+    struct HasCapacity<T, decltype(std::declval<const T>().capacity, void())> : Meta::True {};
+}
+
 class Trip {
 
 public:
     static const std::string CSV_HEADER;
 
 public:
-    Trip(const std::string& tripName = "", const std::string& routeName = "", const int type = -1) :
+    Trip(const std::string& tripName = "", const std::string& routeName = "", const int type = -1, const int capacity = -1) :
         tripName(tripName),
         routeName(routeName),
-        type(type) {
+        type(type),
+        capacity(capacity) {
     }
     template<typename TRIP_TYPE>
     Trip(const TRIP_TYPE& t) :
         tripName(t.tripName),
         routeName(t.routeName),
         type(t.type) {
+        if constexpr (ImplementationDetail::HasCapacity<TRIP_TYPE>::Value) {
+            capacity = t.capacity;
+        }
     }
     Trip(IO::Deserialization& deserialize) {
         this->deserialize(deserialize);
@@ -35,12 +48,16 @@ public:
         return out << "Trip{" << t.routeName << ", " << t.tripName  << ", " << t.type << "}";
     }
 
+    // Capacities are stored since version 1 of the CSA binary format (see Data::serialize)
     inline void serialize(IO::Serialization& serialize) const noexcept {
         serialize(tripName, routeName, type);
+        if (serialize.getFormatVersion() >= 1) serialize(capacity);
     }
 
     inline void deserialize(IO::Deserialization& deserialize) noexcept {
         deserialize(tripName, routeName, type);
+        capacity = -1;
+        if (deserialize.getFormatVersion() >= 1) deserialize(capacity);
     }
 
     inline std::ostream& toCSV(std::ostream& out) const {
@@ -57,6 +74,7 @@ public:
     std::string tripName{""};
     std::string routeName{""};
     int type{-1};
+    int capacity{-1}; // number of passengers, negative if unknown
 
 };
 
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Entities/Connection.h"
+#include "Entities/Stop.h"
+#include "Entities/Trip.h"
+#include "MappedTransferGraph.h"
+
+#include "../Container/Map.h"
+#include "../Container/MappedVector.h"
+#include "../Geometry/Point.h"
+#include "../Graph/Graph.h"
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/FileSystem/FileSystem.h"
+#include "../../Helpers/IO/MappedFile.h"
+
+namespace CSA {
+
+// Fixed-layout binary format of a CSA network that is accessed through a read-only memory mapping, i.e., without parsing.
+// The file consists of a header followed by 64 byte aligned sections: The connections, the stop and trip attributes as
+// one array per attribute (including the station of each stop), an interned string table for stop, trip and route names
+// (names are referenced by string id), and the transfer graph as CSR arrays.
+class MappedData {
+
+public:
+    inline static constexpr char Magic[8] = {'C', 'S', 'A', 'M', 'A', 'P', '\0', '\0'};
+    inline static constexpr uint64_t Version = 2;
+    inline static constexpr size_t Alignment = 64;
+
+    enum Section : uint8_t {
+        Connections,
+        StopCoordinates,
+        StopMinTransferTimes,
+        StopStations,
+        StopNames,
+        TripTypes,
+        TripCapacities,
+        TripNames,
+        RouteNames,
+        StringBegin,
+        StringData,
+        BeginOut,
+        ToVertices,
+        TravelTimes,
+        VertexCoordinates,
+        NumberOfSections
+    };
+
+    struct Header {
+        char magic[8];
+        uint64_t version;
+        uint64_t numberOfConnections;
+        uint64_t numberOfStops;
+        uint64_t numberOfTrips;
+        uint64_t numberOfVertices;
+        uint64_t numberOfEdges;
+        uint64_t numberOfStrings;
+        uint64_t offset[NumberOfSections];
+        uint64_t size[NumberOfSections];
+    };
+
+    static_assert(std::is_trivially_copyable_v<Connection>, "Connections must be trivially copyable!");
+    static_assert(std::is_trivially_copyable_v<Geometry::Point>, "Coordinates must be trivially copyable!");
+    static_assert(std::is_trivially_copyable_v<StopId> && std::is_trivially_copyable_v<Vertex> && std::is_trivially_copyable_v<Edge>, "Ids must be trivially copyable!");
+
+public:
+    MappedData(const std::string& fileName) :
+        file(fileName),
+        header(file.isOpen() && file.size() >= sizeof(Header) ? file.at<Header>(0) : nullptr) {
+        Ensure(header, "Cannot map the file " << fileName << "!");
+        Ensure(std::memcmp(header->magic, Magic, sizeof(Magic)) == 0, "The file " << fileName << " is not a mapped CSA binary!");
+        Ensure(header->version == Version, "The file " << fileName << " has version " << header->version << ", but version " << Version << " is required!");
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            Ensure(header->offset[section] + header->size[section] <= file.size(), "The file " << fileName << " is truncated!");
+        }
+    }
+
+    inline static bool IsMappedFile(const std::string& fileName) noexcept {
+        std::ifstream in(fileName, std::ios::binary);
+        char magic[sizeof(Magic)];
+        if (!in.read(magic, sizeof(magic))) return false;
+        return std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+    }
+
+    inline static void Write(const std::string& fileName, const MappedVector<Connection>& connections, const std::vector<Stop>& stopData, const std::vector<Trip>& tripData, const MappedVector<StopId>& stopStations, const MappedTransferGraph& transferGraph) noexcept {
+        StringTable strings;
+        std::vector<Geometry::Point> stopCoordinates;
+        std::vector<int> stopMinTransferTimes;
+        std::vector<uint32_t> stopNames;
+        for (const Stop& stop : stopData) {
+            stopCoordinates.emplace_back(stop.coordinates);
+            stopMinTransferTimes.emplace_back(stop.minTransferTime);
+            stopNames.emplace_back(strings.intern(stop.name));
+        }
+        std::vector<int> tripTypes;
+        std::vector<int> tripCapacities;
+        std::vector<uint32_t> tripNames;
+        std::vector<uint32_t> routeNames;
+        for (const Trip& trip : tripData) {
+            tripTypes.emplace_back(trip.type);
+            tripCapacities.emplace_back(trip.capacity);
+            tripNames.emplace_back(strings.intern(trip.tripName));
+            routeNames.emplace_back(strings.intern(trip.routeName));
+        }
+
+        Header header;
+        std::memset(&header, 0, sizeof(Header));
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.numberOfConnections = connections.size();
+        header.numberOfStops = stopData.size();
+        header.numberOfTrips = tripData.size();
+        header.numberOfVertices = transferGraph.numVertices();
+        header.numberOfEdges = transferGraph.numEdges();
+        header.numberOfStrings = strings.begin.size() - 1;
+        const std::vector<std::pair<const void*, size_t>> sections = {
+            bytesOf(connections),
+            bytesOf(stopCoordinates),
+            bytesOf(stopMinTransferTimes),
+            bytesOf(stopStations),
+            bytesOf(stopNames),
+            bytesOf(tripTypes),
+            bytesOf(tripCapacities),
+            bytesOf(tripNames),
+            bytesOf(routeNames),
+            bytesOf(strings.begin),
+            bytesOf(strings.data),
+            bytesOf(transferGraph.getBeginOut()),
+            bytesOf(transferGraph[ToVertex]),
+            bytesOf(transferGraph[TravelTime]),
+            bytesOf(transferGraph[Coordinates])
+        };
+        AssertMsg(sections.size() == NumberOfSections, "Number of sections is inconsistent!");
+        uint64_t offset = align(sizeof(Header));
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            header.offset[section] = offset;
+            header.size[section] = sections[section].second;
+            offset = align(offset + sections[section].second);
+        }
+
+        std::ofstream out(FileSystem::ensureDirectoryExists(fileName), std::ios::binary);
+        Ensure(out, "Cannot create the file " << fileName << "!");
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        size_t position = sizeof(Header);
+        for (size_t section = 0; section < NumberOfSections; section++) {
+            const std::vector<char> padding(header.offset[section] - position, 0);
+            out.write(padding.data(), padding.size());
+            out.write(static_cast<const char*>(sections[section].first), sections[section].second);
+            position = header.offset[section] + header.size[section];
+        }
+    }
+
+    inline size_t numberOfConnections() const noexcept {return header->numberOfConnections;}
+    inline size_t numberOfStops() const noexcept {return header->numberOfStops;}
+    inline size_t numberOfTrips() const noexcept {return header->numberOfTrips;}
+    inline size_t numberOfVertices() const noexcept {return header->numberOfVertices;}
+    inline size_t numberOfEdges() const noexcept {return header->numberOfEdges;}
+
+    inline const Connection* connections() const noexcept {return section<Connection>(Connections);}
+    inline const Geometry::Point* stopCoordinates() const noexcept {return section<Geometry::Point>(StopCoordinates);}
+    inline const int* stopMinTransferTimes() const noexcept {return section<int>(StopMinTransferTimes);}
+    inline const StopId* stopStations() const noexcept {return section<StopId>(StopStations);}
+    inline const int* tripTypes() const noexcept {return section<int>(TripTypes);}
+    inline const int* tripCapacities() const noexcept {return section<int>(TripCapacities);}
+    inline const Edge* beginOut() const noexcept {return section<Edge>(BeginOut);}
+    inline const Vertex* toVertices() const noexcept {return section<Vertex>(ToVertices);}
+    inline const int* travelTimes() const noexcept {return section<int>(TravelTimes);}
+    inline const Geometry::Point* vertexCoordinates() const noexcept {return section<Geometry::Point>(VertexCoordinates);}
+
+    inline std::string_view stopName(const StopId stop) const noexcept {return string(section<uint32_t>(StopNames)[stop]);}
+    inline std::string_view tripName(const TripId trip) const noexcept {return string(section<uint32_t>(TripNames)[trip]);}
+    inline std::string_view routeName(const TripId trip) const noexcept {return string(section<uint32_t>(RouteNames)[trip]);}
+
+private:
+    // Every distinct string is stored once, string i consists of the characters data[begin[i]] to data[begin[i + 1] - 1].
+    struct StringTable {
+        StringTable() : begin(1, 0) {}
+
+        inline uint32_t intern(const std::string& string) noexcept {
+            if (idOfString.contains(string)) return idOfString[string];
+            const uint32_t id = begin.size() - 1;
+            data.insert(data.end(), string.begin(), string.end());
+            begin.emplace_back(data.size());
+            idOfString.insert(string, id);
+            return id;
+        }
+
+        std::vector<uint64_t> begin;
+        std::vector<char> data;
+        Map<std::string, uint32_t> idOfString;
+    };
+
+    template<typename VECTOR>
+    inline static std::pair<const void*, size_t> bytesOf(const VECTOR& vector) noexcept {
+        return std::make_pair(static_cast<const void*>(vector.data()), vector.size() * sizeof(vector[0]));
+    }
+
+    inline static uint64_t align(const uint64_t offset) noexcept {
+        return ((offset + Alignment - 1) / Alignment) * Alignment;
+    }
+
+    template<typename T>
+    inline const T* section(const Section section) const noexcept {
+        return file.at<T>(header->offset[section]);
+    }
+
+    inline std::string_view string(const uint32_t id) const noexcept {
+        const uint64_t* begin = section<uint64_t>(StringBegin);
+        return std::string_view(section<char>(StringData) + begin[id], begin[id + 1] - begin[id]);
+    }
+
+private:
+    IO::MappedFile file;
+    const Header* header;
+
+};
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "../Container/MappedVector.h"
+#include "../Geometry/Point.h"
+#include "../Graph/Graph.h"
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Ranges/Range.h"
+
+namespace CSA {
+
+// Read-only transfer graph of the CSA data, stored as CSR arrays that are either owned or views into a memory mapped file
+// (see MappedData). Provides the access functions of the StaticGraph, modifications go through a StaticGraph.
+class MappedTransferGraph {
+
+public:
+    MappedTransferGraph() {
+        beginOut.assign(std::vector<Edge>(1, Edge(0)));
+    }
+
+    MappedTransferGraph(TransferGraph&& graph) {
+        assign(std::move(graph));
+    }
+
+    inline size_t numVertices() const noexcept {return beginOut.size() - 1;}
+    inline size_t numEdges() const noexcept {return toVertex.size();}
+    inline bool isVertex(const Vertex vertex) const noexcept {return vertex < numVertices();}
+    inline bool isEdge(const Edge edge) const noexcept {return edge < numEdges();}
+    inline bool isView() const noexcept {return beginOut.isView();}
+
+    inline size_t outDegree(const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex), vertex << " is not a valid vertex!");
+        return beginOut[vertex + 1] - beginOut[vertex];
+    }
+
+    inline Range<Vertex> vertices() const noexcept {
+        return Range<Vertex>(Vertex(0), Vertex(numVertices()));
+    }
+
+    inline Range<Edge> edgesFrom(const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex), vertex << " is not a valid vertex!");
+        return Range<Edge>(beginOut[vertex], beginOut[vertex + 1]);
+    }
+
+    inline Edge beginEdgeFrom(const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex) || vertex == numVertices(), vertex << " is not a valid vertex!");
+        return beginOut[vertex];
+    }
+
+    inline Edge findEdge(const Vertex from, const Vertex to) const noexcept {
+        if (!isVertex(from)) return noEdge;
+        for (const Edge edge : edgesFrom(from)) {
+            if (toVertex[edge] == to) return edge;
+        }
+        return noEdge;
+    }
+
+    inline bool hasEdge(const Vertex from, const Vertex to) const noexcept {
+        return isEdge(findEdge(from, to));
+    }
+
+    inline Vertex get(const ::ImplementationDetail::ToVertexType, const Edge edge) const noexcept {
+        AssertMsg(isEdge(edge), edge << " is not a valid edge!");
+        return toVertex[edge];
+    }
+
+    inline int get(const ::ImplementationDetail::TravelTimeType, const Edge edge) const noexcept {
+        AssertMsg(isEdge(edge), edge << " is not a valid edge!");
+        return travelTime[edge];
+    }
+
+    inline const Geometry::Point& get(const ::ImplementationDetail::CoordinatesType, const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex), vertex << " is not a valid vertex!");
+        return coordinates[vertex];
+    }
+
+    inline const MappedVector<Edge>& getBeginOut() const noexcept {return beginOut;}
+    inline const MappedVector<Vertex>& operator[](const ::ImplementationDetail::ToVertexType) const noexcept {return toVertex;}
+    inline const MappedVector<int>& operator[](const ::ImplementationDetail::TravelTimeType) const noexcept {return travelTime;}
+    inline const MappedVector<Geometry::Point>& operator[](const ::ImplementationDetail::CoordinatesType) const noexcept {return coordinates;}
+
+    // The arrays have to stay valid as long as the graph is used, beginOut has numVertices + 1 entries.
+    inline void view(const Edge* newBeginOut, const Vertex* newToVertex, const int* newTravelTime, const Geometry::Point* newCoordinates, const size_t numVertices, const size_t numEdges) noexcept {
+        beginOut.view(newBeginOut, numVertices + 1);
+        toVertex.view(newToVertex, numEdges);
+        travelTime.view(newTravelTime, numEdges);
+        coordinates.view(newCoordinates, numVertices);
+    }
+
+    inline void assign(TransferGraph&& graph) noexcept {
+        std::vector<Edge> newBeginOut;
+        newBeginOut.reserve(graph.numVertices() + 1);
+        for (const Vertex vertex : graph.vertices()) {
+            newBeginOut.emplace_back(graph.beginEdgeFrom(vertex));
+        }
+        newBeginOut.emplace_back(Edge(graph.numEdges()));
+        beginOut.assign(std::move(newBeginOut));
+        toVertex.assign(std::move(graph[ToVertex]));
+        travelTime.assign(std::move(graph[TravelTime]));
+        coordinates.assign(std::move(graph[Coordinates]));
+    }
+
+    // Copy of the graph, for algorithms that require a StaticGraph.
+    inline TransferGraph toStaticGraph() const noexcept {
+        TransferGraph graph;
+        graph.assignAdjacency(beginOut.data(), numVertices(), toVertex.data());
+        graph[TravelTime].assign(travelTime.begin(), travelTime.end());
+        graph[Coordinates].assign(coordinates.begin(), coordinates.end());
+        return graph;
+    }
+
+    template<typename FUNCTION>
+    inline void modify(const FUNCTION& function) noexcept {
+        TransferGraph graph = toStaticGraph();
+        function(graph);
+        assign(std::move(graph));
+    }
+
+    inline void printAnalysis(std::ostream& out = std::cout) const noexcept {
+        toStaticGraph().printAnalysis(out);
+    }
+
+private:
+    MappedVector<Edge> beginOut;
+    MappedVector<Vertex> toVertex;
+    MappedVector<int> travelTime;
+    MappedVector<Geometry::Point> coordinates;
+
+};
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "Data.h"
+#include "Entities/Connection.h"
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace CSA {
+
+// View of a timetable that repeats after one period, which replaces the copies created by Data::duplicateConnections().
+// The connections 0, ..., n - 1 are the original ones, and connection n + i is the copy of connection i on the next day,
+// whose times and trip id are shifted on the fly. Only copies that depart within the horizon after the start of the
+// next day are included. The scan order contains the ids of all connections sorted by departure time, in the same
+// order as after duplicateConnections() and sortConnectionsAscendingByDepartureTime().
+class PeriodicTimetable {
+
+public:
+    PeriodicTimetable(const Data& data, const int period = 24 * 60 * 60, const int horizon = 24 * 60 * 60) :
+        data(data),
+        period(period),
+        numberOfOriginalConnections(data.numberOfConnections()),
+        numberOfCopies(0) {
+        while (numberOfCopies < numberOfOriginalConnections && data.connections[numberOfCopies].departureTime < horizon) {
+            numberOfCopies++;
+        }
+        order.reserve(numberOfOriginalConnections + numberOfCopies);
+        size_t copy = 0;
+        for (size_t i = 0; i < numberOfOriginalConnections; i++) {
+            AssertMsg(i == 0 || data.connections[i - 1].departureTime <= data.connections[i].departureTime, "Connections are not sorted by departure time!");
+            while (copy < numberOfCopies && data.connections[copy].departureTime + period < data.connections[i].departureTime) {
+                order.emplace_back(ConnectionId(numberOfOriginalConnections + copy++));
+            }
+            order.emplace_back(ConnectionId(i));
+        }
+        while (copy < numberOfCopies) {
+            order.emplace_back(ConnectionId(numberOfOriginalConnections + copy++));
+        }
+    }
+
+    // Number of original connections and copies
+    inline size_t numberOfConnections() const noexcept {
+        return order.size();
+    }
+
+    // Every trip has a copy on the next day
+    inline size_t numberOfTrips() const noexcept {
+        return 2 * data.numberOfTrips();
+    }
+
+    inline const std::vector<ConnectionId>& scanOrder() const noexcept {
+        return order;
+    }
+
+    inline bool isCopy(const ConnectionId i) const noexcept {
+        return i >= numberOfOriginalConnections;
+    }
+
+    inline ConnectionId originalConnection(const ConnectionId i) const noexcept {
+        return isCopy(i) ? ConnectionId(i - numberOfOriginalConnections) : i;
+    }
+
+    inline Connection connection(const ConnectionId i) const noexcept {
+        AssertMsg(i < numberOfConnections(), "Connection " << i << " is out of bounds!");
+        return isCopy(i) ? Connection(data.connections[i - numberOfOriginalConnections], period, data.numberOfTrips()) : data.connections[i];
+    }
+
+    inline long long byteSize() const noexcept {
+        return sizeof(*this) + Vector::byteSize(order);
+    }
+
+private:
+    const Data& data;
+    int period;
+    size_t numberOfOriginalConnections;
+    size_t numberOfCopies;
+    std::vector<ConnectionId> order;
+};
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/IO/Serialization.h"
+
+// Read-only array that either owns its elements or is a view into memory that is kept alive elsewhere, e.g. by a memory
+// mapped file. Elements can only be changed via assign() and modify(), the latter copies the elements of a view first.
+template<typename VALUE>
+class MappedVector {
+
+public:
+    using Value = VALUE;
+    using Type = MappedVector<Value>;
+    using Iterator = const Value*;
+
+public:
+    MappedVector() :
+        first(nullptr),
+        count(0),
+        mapped(false) {
+    }
+
+    MappedVector(const Type& other) :
+        elements(other.elements) {
+        adopt(other);
+    }
+
+    MappedVector(Type&& other) noexcept :
+        elements(std::move(other.elements)) {
+        adopt(other);
+        other.reset();
+    }
+
+    inline Type& operator=(const Type& other) noexcept {
+        if (this == &other) return *this;
+        elements = other.elements;
+        adopt(other);
+        return *this;
+    }
+
+    inline Type& operator=(Type&& other) noexcept {
+        if (this == &other) return *this;
+        elements = std::move(other.elements);
+        adopt(other);
+        other.reset();
+        return *this;
+    }
+
+    inline size_t size() const noexcept {return count;}
+    inline bool empty() const noexcept {return count == 0;}
+    inline bool isView() const noexcept {return mapped;}
+
+    inline const Value& operator[](const size_t i) const noexcept {
+        AssertMsg(i < count, "Index " << i << " is out of bounds (size: " << count << ")!");
+        return first[i];
+    }
+
+    inline const Value* data() const noexcept {return first;}
+    inline Iterator begin() const noexcept {return first;}
+    inline Iterator end() const noexcept {return first + count;}
+    inline const Value& front() const noexcept {return (*this)[0];}
+    inline const Value& back() const noexcept {return (*this)[count - 1];}
+
+    // The memory has to stay valid as long as the view is used.
+    inline void view(const Value* data, const size_t size) noexcept {
+        std::vector<Value>().swap(elements);
+        first = data;
+        count = size;
+        mapped = true;
+    }
+
+    inline void assign(std::vector<Value>&& vector) noexcept {
+        elements = std::move(vector);
+        synchronize();
+    }
+
+    template<typename FUNCTION>
+    inline void modify(const FUNCTION& function) noexcept {
+        if (mapped) elements.assign(begin(), end());
+        function(elements);
+        synchronize();
+    }
+
+    // Same format as a serialized std::vector.
+    inline void serialize(IO::Serialization& serialize) const noexcept {
+        if (mapped) {
+            serialize(std::vector<Value>(begin(), end()));
+        } else {
+            serialize(elements);
+        }
+    }
+
+    inline void deserialize(IO::Deserialization& deserialize) noexcept {
+        deserialize(elements);
+        synchronize();
+    }
+
+private:
+    inline void synchronize() noexcept {
+        first = elements.data();
+        count = elements.size();
+        mapped = false;
+    }
+
+    inline void adopt(const Type& other) noexcept {
+        first = other.mapped ? other.first : elements.data();
+        count = other.count;
+        mapped = other.mapped;
+    }
+
+    inline void reset() noexcept {
+        elements.clear();
+        synchronize();
+    }
+
+private:
+    std::vector<Value> elements;
+    const Value* first;
+    size_t count;
+    bool mapped;
+
+};
@@ -14,6 +14,7 @@
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/IO/Serialization.h"
 #include "../../Helpers/IO/ParserCSV.h"
+#include "../../Helpers/IO/ParallelCSVReader.h"
 #include "../../Helpers/String/String.h"
 
 class AccumulatedVertexDemand {
@@ -127,25 +128,27 @@ public:
         AccumulatedVertexDemand result;
         if (FileSystem::isFile(filename)) {
             Timer timer;
-            size_t count = 0;
             int firstDeparture = std::numeric_limits<int>::max();
             int lastDeparture = std::numeric_limits<int>::min();
-            IO::CSVReader<5, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(filename);
+            IO::ParallelCSVReader<5, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(filename);
             in.readHeader(alias{"min_dep_time", "MINDEPARTURE[SEC]", "MIN_DEPARTURE[SEC]"}, alias{"max_dep_time", "MAXDEPARTURE[SEC]", "MAX_DEPARTURE[SEC]"}, alias{"dep_zone", "FROMZONENO[-]"}, alias{"arr_zone", "TOZONENO[-]"}, alias{"passenger_count", "DEMAND[-]"});
-            Entry demand(-1, -1, noVertex, noVertex, -1);
-            double passengerFlow;
-            while (in.readRow(demand.earliestDepartureTime, demand.latestDepartureTime, demand.originVertex, demand.destinationVertex, passengerFlow)) {
+            const std::vector<Entry> entries = in.readRows<Entry>([&](const auto& row, Entry& demand) {
+                double passengerFlow;
+                row.parse(demand.earliestDepartureTime, demand.latestDepartureTime, demand.originVertex, demand.destinationVertex, passengerFlow);
                 demand.numberOfPassengers = passengerFlow * multiplier;
-                count++;
-                if (demand.numberOfPassengers <= 0) continue;
-                if (demand.latestDepartureTime < demand.earliestDepartureTime) continue;
-                if (demand.originVertex == demand.destinationVertex) continue;
+                if (demand.numberOfPassengers <= 0) return false;
+                if (demand.latestDepartureTime < demand.earliestDepartureTime) return false;
+                if (demand.originVertex == demand.destinationVertex) return false;
                 demand.originVertex += data.numberOfStops();
-                if (!data.transferGraph.isVertex(demand.originVertex)) continue;
-                if (data.transferGraph.outDegree(demand.originVertex) == 0) continue;
+                if (!data.transferGraph.isVertex(demand.originVertex)) return false;
+                if (data.transferGraph.outDegree(demand.originVertex) == 0) return false;
                 demand.destinationVertex += data.numberOfStops();
-                if (!data.transferGraph.isVertex(demand.destinationVertex)) continue;
-                if (reverseGraph.outDegree(demand.destinationVertex) == 0) continue;
+                if (!data.transferGraph.isVertex(demand.destinationVertex)) return false;
+                if (reverseGraph.outDegree(demand.destinationVertex) == 0) return false;
+                return true;
+            });
+            const size_t count = in.numberOfRows();
+            for (Entry demand : entries) {
                 demand.demandIndex = result.entries.size();
                 result.entries.emplace_back(demand);
                 result.numberOfPassengers += demand.numberOfPassengers;
@@ -184,7 +184,8 @@ public:
         for (const GlobalPassengerId id : walkingPassengers) {
             passengersWithoutConnection.insert(id);
         }
-        Dijkstra<TransferGraph> dijkstra(data.transferGraph);
+        const TransferGraph transferGraph = data.transferGraph.toStaticGraph();
+        Dijkstra<TransferGraph> dijkstra(transferGraph);
         std::set<Path> paths;
         Progress progress(entryCount);
         progress.SetCheckTimeStep(1000);
@@ -223,7 +224,7 @@ public:
                     newEntry.arrivalTime = data.connections[connections.back()].arrivalTime + getTravelTime<true>(data, dijkstra, data.connections[connections.back()].arrivalStopId, destinationVertex);
                     newEntry.travelTimeWithoutInitialWaiting = data.connections[connections.back()].arrivalTime - data.connections[connections.front()].departureTime;
                     newEntry.travelTimeWithInitialWaiting = data.connections[connections.back()].arrivalTime - entry.departureTime;
-                    newEntry.beelineDistanceST = Geometry::geoDistanceInCM(data.stopData[newEntry.firstStop].coordinates, data.stopData[newEntry.lastStop].coordinates) / 100.0;
+                    newEntry.beelineDistanceST = Geometry::geoDistanceInCM(data.getStopData()[newEntry.firstStop].coordinates, data.getStopData()[newEntry.lastStop].coordinates) / 100.0;
                     newEntry.timeInVehicle = 0;
                     newEntry.pathDistance = 0;
                     std::set<TripId> trips;
@@ -233,7 +234,7 @@ public:
                         path.data.emplace_back(i);
                         trips.insert(data.connections[i].tripId);
                         newEntry.timeInVehicle += data.connections[i].travelTime();
-                        newEntry.pathDistance += Geometry::geoDistanceInCM(data.stopData[data.connections[i].departureStopId].coordinates, data.stopData[data.connections[i].arrivalStopId].coordinates) / 100.0;
+                        newEntry.pathDistance += Geometry::geoDistanceInCM(data.getStopData()[data.connections[i].departureStopId].coordinates, data.getStopData()[data.connections[i].arrivalStopId].coordinates) / 100.0;
                     }
                     path.data.emplace_back(destinationVertex);
                     path.data.shrink_to_fit();
@@ -512,8 +513,8 @@ public:
         for (const StopId source : data.stops()) {
             for (std::pair<StopId, size_t> entry : demandBySourceStop[source]) {
                 os << source << "," << entry.first;
-                os << "," << data.stopData[source].coordinates.latitude << "," << data.stopData[source].coordinates.longitude;
-                os << "," << data.stopData[entry.first].coordinates.latitude << "," << data.stopData[entry.first].coordinates.longitude;
+                os << "," << data.getStopData()[source].coordinates.latitude << "," << data.getStopData()[source].coordinates.longitude;
+                os << "," << data.getStopData()[entry.first].coordinates.latitude << "," << data.getStopData()[entry.first].coordinates.longitude;
                 os << "," << entry.second;
                 os << "\n";
             }
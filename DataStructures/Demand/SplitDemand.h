@@ -1,10 +1,14 @@
 #pragma once
 
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "../Container/Map.h"
 #include "../Container/Set.h"
 #include "../CSA/Data.h"
 #include "../../Helpers/Types.h"
+#include "../../Helpers/IO/Serialization.h"
 
 template<typename DEMAND_TYPE>
 class SplitDemand {
@@ -21,6 +25,12 @@ public:
     }) {
     }
 
+    inline static SplitDemand FromBinary(const std::string& fileName) noexcept {
+        SplitDemand result;
+        result.deserialize(fileName);
+        return result;
+    }
+
     inline size_t size() const noexcept {
         return verticesWithDemand.size();
     }
@@ -37,7 +47,55 @@ public:
         return entries[vertex];
     }
 
+    // Non-stop destinations that are connected to the same stops with the same transfer times yield identical PATs.
+    // The demand of all destinations within such an equivalence class is moved to the first destination of the class,
+    // such that the PATs are computed only once per class. The demand entries keep their original destination vertex.
+    // Returns the number of destinations that have been merged into another one.
+    inline size_t mergeEquivalentDestinations(const CSA::Data& data, const CSA::TransferGraph& reverseGraph) noexcept {
+        Map<std::vector<std::pair<Vertex, int>>, Vertex> representativeBySignature;
+        std::vector<Vertex> representatives;
+        for (const Vertex vertex : verticesWithDemand) {
+            if (data.isStop(vertex)) {
+                representatives.emplace_back(vertex);
+                continue;
+            }
+            const std::vector<std::pair<Vertex, int>> signature = destinationSignature(data, reverseGraph, vertex);
+            if (representativeBySignature.contains(signature)) {
+                std::vector<DEMAND_TYPE>& representativeEntries = entries[representativeBySignature[signature]];
+                representativeEntries.insert(representativeEntries.end(), entries[vertex].begin(), entries[vertex].end());
+                std::vector<DEMAND_TYPE>().swap(entries[vertex]);
+            } else {
+                representativeBySignature.insert(signature, vertex);
+                representatives.emplace_back(vertex);
+            }
+        }
+        const size_t numberOfMergedVertices = verticesWithDemand.size() - representatives.size();
+        verticesWithDemand.swap(representatives);
+        return numberOfMergedVertices;
+    }
+
+    inline void serialize(const std::string& fileName) const noexcept {
+        IO::serialize(fileName, entries, verticesWithDemand);
+    }
+
+    inline void deserialize(const std::string& fileName) noexcept {
+        IO::deserialize(fileName, entries, verticesWithDemand);
+    }
+
 private:
+    SplitDemand() {}
+
+    inline static std::vector<std::pair<Vertex, int>> destinationSignature(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Vertex vertex) noexcept {
+        std::vector<std::pair<Vertex, int>> signature;
+        for (const Edge edge : reverseGraph.edgesFrom(vertex)) {
+            const Vertex stop = reverseGraph.get(ToVertex, edge);
+            if (!data.isStop(stop)) continue;
+            signature.emplace_back(stop, reverseGraph.get(TravelTime, edge));
+        }
+        std::sort(signature.begin(), signature.end());
+        return signature;
+    }
+
     template<typename SPLIT_VERTEX>
     SplitDemand(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const std::vector<DEMAND_TYPE>& demand, const bool allowDepartureStops, const SPLIT_VERTEX& splitVertex) {
         IndexedSet<false, Vertex> set(data.transferGraph.numVertices());
@@ -6,6 +6,9 @@
 #include <type_traits>
 #include <iomanip>
 #include <algorithm>
+#include <tuple>
+
+#include <omp.h>
 
 #include "GraphInterface.h"
 
@@ -233,6 +236,115 @@ public:
         return addEdge(from, to).set(record);
     }
 
+    // Replaces the adjacency structure by the given CSR arrays, where beginOut has numVertices + 1 entries. All other
+    // attributes are default initialized and can be assigned in bulk via operator[] afterwards.
+    inline void assignAdjacency(const Edge* newBeginOut, const size_t numVertices, const Vertex* toVertex) noexcept {
+        static_assert(!HasEdgeAttribute(ReverseEdge), "Cannot assign the adjacency of a graph with reverse edge pointers!");
+        beginOut.assign(newBeginOut, newBeginOut + numVertices + 1);
+        vertexAttributes.clear();
+        vertexAttributes.resize(numVertices);
+        edgeAttributes.clear();
+        edgeAttributes.resize(beginOut.back());
+        get(ToVertex).assign(toVertex, toVertex + beginOut.back());
+        if constexpr (HasEdgeAttribute(FromVertex)) {
+            for (const Vertex from : vertices()) {
+                for (const Edge edge : edgesFrom(from)) {
+                    set(FromVertex, edge, from);
+                }
+            }
+        }
+        checkVectorSize();
+        Assert(satisfiesInvariants());
+    }
+
+    struct BufferedEdge {
+        Vertex from;
+        Vertex to;
+        EdgeRecord record;
+    };
+
+    // Replaces all edges by the buffered edges, which are grouped by their from vertex with a parallel counting sort.
+    // The edges of a vertex keep the order of the buffers, thus the result does not depend on the number of threads.
+    inline void assignEdges(const std::vector<std::vector<BufferedEdge>>& buffers, const int numberOfThreads = omp_get_max_threads()) noexcept {
+        size_t numberOfBufferedEdges = 0;
+        for (const std::vector<BufferedEdge>& buffer : buffers) {
+            numberOfBufferedEdges += buffer.size();
+        }
+        const size_t threadCount = std::min<size_t>(numberOfSortBlocks(numberOfThreads, numberOfBufferedEdges), std::max<size_t>(1, buffers.size()));
+        std::vector<size_t> bufferBegin(threadCount + 1);
+        for (size_t t = 0; t <= threadCount; t++) {
+            bufferBegin[t] = (buffers.size() * t) / threadCount;
+        }
+        assignEdgeBlocks(threadCount, [&](const size_t t, const auto& function) {
+            for (size_t b = bufferBegin[t]; b < bufferBegin[t + 1]; b++) {
+                for (const BufferedEdge& edge : buffers[b]) {
+                    function(edge);
+                }
+            }
+        });
+    }
+
+    // Same as above for a single buffer, which is split into blocks that are processed in parallel.
+    inline void assignEdges(const std::vector<BufferedEdge>& edges, const int numberOfThreads = omp_get_max_threads()) noexcept {
+        const size_t threadCount = numberOfSortBlocks(numberOfThreads, edges.size());
+        assignEdgeBlocks(threadCount, [&](const size_t t, const auto& function) {
+            for (size_t i = (edges.size() * t) / threadCount; i < (edges.size() * (t + 1)) / threadCount; i++) {
+                function(edges[i]);
+            }
+        });
+    }
+
+    // Sorts the edges of every vertex by their to vertex in parallel and keeps only the edge with the smallest value of
+    // the attribute among parallel edges.
+    template<AttributeNameType ATTRIBUTE_NAME>
+    inline void reduceMultiEdgesBy(const AttributeNameWrapper<ATTRIBUTE_NAME> attributeName, const int numberOfThreads = omp_get_max_threads()) noexcept {
+        static_assert(!HasEdgeAttribute(ReverseEdge), "Multi-edges cannot be reduced in a graph with reverse edge pointers!");
+        const size_t n = numVertices();
+        std::vector<Edge> edgeOrder = Vector::id<Edge>(numEdges());
+        std::vector<size_t> degree(n, 0);
+        #pragma omp parallel for num_threads(numberOfThreads) schedule(dynamic, 256)
+        for (size_t v = 0; v < n; v++) {
+            const auto begin = edgeOrder.begin() + beginOut[v];
+            const auto end = edgeOrder.begin() + beginOut[v + 1];
+            std::sort(begin, end, [&](const Edge a, const Edge b) {
+                return std::make_tuple(get(ToVertex, a), get(attributeName, a), a) < std::make_tuple(get(ToVertex, b), get(attributeName, b), b);
+            });
+            degree[v] = std::unique(begin, end, [&](const Edge a, const Edge b) {
+                return get(ToVertex, a) == get(ToVertex, b);
+            }) - begin;
+        }
+        std::vector<Edge> newBeginOut(n + 1);
+        size_t edgeCount = 0;
+        for (size_t v = 0; v < n; v++) {
+            newBeginOut[v] = Edge(edgeCount);
+            edgeCount += degree[v];
+        }
+        newBeginOut[n] = Edge(edgeCount);
+        std::vector<Edge> keptEdges(edgeCount);
+        #pragma omp parallel for num_threads(numberOfThreads) schedule(static)
+        for (size_t v = 0; v < n; v++) {
+            std::copy(edgeOrder.begin() + beginOut[v], edgeOrder.begin() + beginOut[v] + degree[v], keptEdges.begin() + newBeginOut[v]);
+        }
+        edgeAttributes.forEach([&](auto& values) {
+            std::decay_t<decltype(values)> result(edgeCount);
+            if constexpr (std::is_same_v<std::decay_t<decltype(values)>, std::vector<bool>>) {
+                for (size_t i = 0; i < edgeCount; i++) {
+                    result[i] = values[keptEdges[i]];
+                }
+            } else {
+                #pragma omp parallel for num_threads(numberOfThreads) schedule(static)
+                for (size_t i = 0; i < edgeCount; i++) {
+                    result[i] = values[keptEdges[i]];
+                }
+            }
+            values.swap(result);
+        });
+        edgeAttributes.resize(edgeCount);
+        beginOut.swap(newBeginOut);
+        checkVectorSize();
+        Assert(satisfiesInvariants());
+    }
+
     inline void redirectEdge(const Edge edge, const Vertex oldFrom, const Vertex newTo) noexcept {
         AssertMsg(isVertex(oldFrom), oldFrom << " is not a valid vertex!");
         AssertMsg(isVertex(newTo), newTo << " is not a valid vertex!");
@@ -351,22 +463,30 @@ public:
         changeVertexIds(order, Permutation(Construct::Invert, order));
     }
 
-    inline void revert() noexcept {
+    // Transposes the graph with a parallel counting sort. The incoming edges of a vertex keep the order of their ids.
+    inline void revert(const int numberOfThreads = omp_get_max_threads()) noexcept {
         if (numEdges() == 0) return;
-        std::vector<Edge> newBeginOut(beginOut.size(), Edge(0));
-        std::vector<Vertex> fromVertex(numEdges());
-        for (const auto [edge, from] : edgesWithFromVertex()) {
-            newBeginOut[get(ToVertex, edge) + 1]++;
-            fromVertex[edge] = from;
-        }
-        for (size_t i = 1; i < newBeginOut.size(); i++) {
-            newBeginOut[i] += newBeginOut[i - 1];
+        const size_t m = numEdges();
+        std::vector<Vertex> fromVertex(m);
+        #pragma omp parallel for num_threads(numberOfThreads) schedule(static)
+        for (size_t v = 0; v < numVertices(); v++) {
+            for (const Edge edge : edgesFrom(Vertex(v))) {
+                fromVertex[edge] = Vertex(v);
+            }
         }
-        std::vector<Edge> firstEdge = newBeginOut;
-        Permutation edgePermutation(numEdges());
-        for (Edge edge(0); edge < numEdges(); edge++) {
-            const Vertex toVertex = get(ToVertex, edge);
-            edgePermutation[edge] = firstEdge[toVertex]++;
+        const size_t threadCount = numberOfSortBlocks(numberOfThreads, m);
+        std::vector<Edge> newBeginOut;
+        std::vector<std::vector<size_t>> offset = countingSortByVertex(threadCount, [&](const size_t t, const auto& function) {
+            for (size_t edge = (m * t) / threadCount; edge < (m * (t + 1)) / threadCount; edge++) {
+                function(get(ToVertex, Edge(edge)));
+            }
+        }, newBeginOut);
+        Permutation edgePermutation(m);
+        #pragma omp parallel for num_threads(threadCount) schedule(static, 1)
+        for (size_t t = 0; t < threadCount; t++) {
+            for (size_t edge = (m * t) / threadCount; edge < (m * (t + 1)) / threadCount; edge++) {
+                edgePermutation[edge] = offset[t][get(ToVertex, Edge(edge))]++;
+            }
         }
         if constexpr (HasEdgeAttribute(FromVertex)) {
             get(ToVertex).swap(get(FromVertex));
@@ -721,6 +841,80 @@ private:
         AssertMsg(satisfiesInvariants(), "Invariants not satisfied!");
     }
 
+    // The counting sort keeps numberOfVertices offsets per block. Limiting the blocks to numberOfItems / numberOfVertices
+    // (and MaxSortBlocks) keeps the offsets within the size of the sorted items.
+    inline static constexpr size_t MaxSortBlocks = 16;
+
+    inline size_t numberOfSortBlocks(const int numberOfThreads, const size_t numberOfItems) const noexcept {
+        const size_t maxBlocks = std::min<size_t>(MaxSortBlocks, numberOfItems / std::max<size_t>(1, numVertices()));
+        return std::max<size_t>(1, std::min<size_t>(std::max(numberOfThreads, 1), maxBlocks));
+    }
+
+    // Stable counting sort by vertex: forEachItem(t, function) calls function(vertex) for every item of block t in order,
+    // the blocks are processed in parallel. Sets begin to the first position of every vertex and returns the position of
+    // the first item of every block and vertex.
+    template<typename FOR_EACH_ITEM>
+    inline std::vector<std::vector<size_t>> countingSortByVertex(const size_t numberOfBlocks, const FOR_EACH_ITEM& forEachItem, std::vector<Edge>& begin) const noexcept {
+        const size_t n = numVertices();
+        std::vector<std::vector<size_t>> offset(numberOfBlocks, std::vector<size_t>(n, 0));
+        #pragma omp parallel for num_threads(numberOfBlocks) schedule(static, 1)
+        for (size_t t = 0; t < numberOfBlocks; t++) {
+            forEachItem(t, [&](const Vertex vertex) {
+                AssertMsg(isVertex(vertex), vertex << " is not a valid vertex!");
+                offset[t][vertex]++;
+            });
+        }
+        std::vector<size_t> count(n, 0);
+        #pragma omp parallel for num_threads(numberOfBlocks) schedule(static)
+        for (size_t v = 0; v < n; v++) {
+            for (size_t t = 0; t < numberOfBlocks; t++) {
+                const size_t items = offset[t][v];
+                offset[t][v] = count[v];
+                count[v] += items;
+            }
+        }
+        begin.assign(n + 1, Edge(0));
+        size_t itemCount = 0;
+        for (size_t v = 0; v < n; v++) {
+            begin[v] = Edge(itemCount);
+            itemCount += count[v];
+        }
+        begin[n] = Edge(itemCount);
+        #pragma omp parallel for num_threads(numberOfBlocks) schedule(static)
+        for (size_t v = 0; v < n; v++) {
+            for (size_t t = 0; t < numberOfBlocks; t++) {
+                offset[t][v] += size_t(begin[v]);
+            }
+        }
+        return offset;
+    }
+
+    // forEachEdge(t, function) calls function(edge) for every buffered edge of block t in order.
+    template<typename FOR_EACH_EDGE>
+    inline void assignEdgeBlocks(const size_t numberOfBlocks, const FOR_EACH_EDGE& forEachEdge) noexcept {
+        static_assert(!HasEdgeAttribute(ReverseEdge), "Buffered edges cannot be assigned to a graph with reverse edge pointers!");
+        std::vector<std::vector<size_t>> offset = countingSortByVertex(numberOfBlocks, [&](const size_t t, const auto& function) {
+            forEachEdge(t, [&](const BufferedEdge& edge) {
+                function(edge.from);
+            });
+        }, beginOut);
+        edgeAttributes.clear();
+        edgeAttributes.resize(size_t(beginOut.back()));
+        #pragma omp parallel for num_threads(numberOfBlocks) schedule(static, 1)
+        for (size_t t = 0; t < numberOfBlocks; t++) {
+            forEachEdge(t, [&](const BufferedEdge& edge) {
+                const Edge newEdge = Edge(offset[t][edge.from]++);
+                edgeAttributes.set(newEdge, edge.record);
+                set(ToVertex, newEdge, edge.to);
+                if constexpr (HasEdgeAttribute(FromVertex)) {
+                    set(FromVertex, newEdge, edge.from);
+                }
+            });
+        }
+        checkVectorSize();
+        Assert(satisfiesInvariants());
+    }
+
 public:
     inline void checkVectorSize() const noexcept {
         AssertMsg(beginOut.size() > 0, "Adjacency structure is empty!");
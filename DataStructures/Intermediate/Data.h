@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <tuple>
 
 #include "Entities/Stop.h"
 #include "Entities/StopEvent.h"
@@ -30,6 +31,7 @@
 #include "../../Helpers/Console/ProgressBar.h"
 #include "../../Algorithms/StronglyConnectedComponents.h"
 #include "../../Algorithms/Dijkstra/Dijkstra.h"
+#include "../../Algorithms/Dijkstra/TransitiveEdges.h"
 
 namespace Intermediate {
 
@@ -245,10 +247,10 @@ public:
     template<typename CSA>
     inline static Data FromCSA(const CSA& csa, const bool validate = false) noexcept {
         Intermediate::Data data;
-        for (const auto& stop : csa.stopData) {
+        for (const auto& stop : csa.getStopData()) {
             data.stops.emplace_back(stop);
         }
-        for (const auto& trip : csa.tripData) {
+        for (const auto& trip : csa.getTripData()) {
             data.trips.emplace_back(trip);
         }
         for (const auto& connection : csa.connections) {
@@ -263,7 +265,7 @@ public:
             b.arrivalTime = std::max(a.departureTime + 1, b.arrivalTime);
             b.departureTime = std::max(b.arrivalTime, b.departureTime);
         }
-        auto graph = csa.transferGraph;
+        auto graph = csa.transferGraph.toStaticGraph();
         Graph::move(std::move(graph), data.transferGraph);
         if (validate) data.validate();
         return data;
@@ -580,7 +582,7 @@ public:
         if (verbose) std::cout << " done." << std::endl;
     }
 
-    inline void makeTransitiveStopGraph(const bool verbose = false) noexcept {
+    inline void makeTransitiveStopGraph(const bool verbose = false, const int maxWalkingTime = intMax, const size_t maxNeighbors = -1) noexcept {
         TransferGraph graph;
         graph.addVertices(transferGraph.numVertices());
         for (const Vertex from : transferGraph.vertices()) {
@@ -591,17 +593,20 @@ public:
             }
         }
         transferGraph.deleteVertices([&](const Vertex vertex){return vertex >= stops.size();});
-        Dijkstra<TransferGraph, false> dijkstra(transferGraph, transferGraph[TravelTime]);
-        Progress progress(stops.size(), verbose);
+        using BufferedEdge = std::tuple<Vertex, Vertex, int>;
+        std::vector<std::vector<BufferedEdge>> buffers;
+        collectTransitiveEdges(transferGraph, Vertex(0), Vertex(stops.size()), buffers, [](const auto& dijkstra, const Vertex stop, const Vertex u, std::vector<BufferedEdge>& buffer) {
+            if (u >= stop) return;
+            buffer.emplace_back(stop, u, dijkstra.getDistance(u));
+        }, verbose, maxWalkingTime, maxNeighbors);
         for (const StopId stop : stopIds()) {
             graph.set(Coordinates, stop, stops[stop].coordinates);
-            dijkstra.run(stop, noVertex, [&](const Vertex u) {
-                if (u >= stop) return;
-                const int travelTime = dijkstra.getDistance(u);
+        }
+        for (const std::vector<BufferedEdge>& buffer : buffers) {
+            for (const auto& [stop, u, travelTime] : buffer) {
                 graph.addEdge(stop, u).set(TravelTime, travelTime);
                 graph.addEdge(u, stop).set(TravelTime, travelTime);
-            });
-            progress++;
+            }
         }
         graph.packEdges();
         Graph::move(std::move(graph), transferGraph);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 64 bit FNV-1a hashes, used to detect whether cached results are still valid.
+namespace Hash {
+
+inline constexpr uint64_t Initial = 14695981039346656037ull;
+
+inline uint64_t bytes(const void* data, const size_t size, uint64_t value = Initial) noexcept {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 1099511628211ull;
+    }
+    return value;
+}
+
+inline uint64_t string(const std::string& s, const uint64_t value = Initial) noexcept {
+    return bytes(s.data(), s.size(), value);
+}
+
+template<typename T>
+inline uint64_t object(const T& object, const uint64_t value = Initial) noexcept {
+    return bytes(&object, sizeof(T), value);
+}
+
+// Files that do not exist do not change the hash value.
+inline uint64_t file(const std::string& fileName, uint64_t value = Initial) noexcept {
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open()) return value;
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        value = bytes(buffer.data(), file.gcount(), value);
+    }
+    return value;
+}
+
+// Hash of a CSA binary including its transfer graph.
+inline uint64_t csaBinary(const std::string& fileName, uint64_t value = Initial) noexcept {
+    value = file(fileName, value);
+    for (const char* attribute : {".graph.beginOut", ".graph.toVertex", ".graph.travelTime"}) {
+        value = file(fileName + attribute, value);
+    }
+    return value;
+}
+
+inline std::string toString(const uint64_t value) noexcept {
+    std::stringstream result;
+    result << std::hex << std::setw(16) << std::setfill('0') << value;
+    return result.str();
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "ParserCSV.h"
+
+#include "../Assert.h"
+
+namespace IO {
+
+// Rewrites a CSV file in a single streaming pass: header columns can be renamed and the values of selected columns can be
+// replaced. All other columns are copied verbatim (including their quotes), so only the current line is held in memory.
+template<class TRIM_POLICY = TrimChars<>, class QUOTE_POLICY = DoubleQuoteEscape<',','"'>, class COMMENT_POLICY = EmptyLineComment>
+class CSVRewriter {
+
+public:
+    // Receives the unescaped value and the index of the row (excluding the header) and returns the new value.
+    using ReplaceValue = std::function<std::string(const std::string& value, const size_t row)>;
+
+    CSVRewriter(const std::string& fileName) : fileName(fileName) {}
+
+    inline CSVRewriter& renameColumn(const std::string& oldName, const std::string& newName) noexcept {
+        newColumnName[oldName] = newName;
+        return *this;
+    }
+
+    // The column is identified by its name after renaming.
+    inline CSVRewriter& replaceValues(const std::string& columnName, const ReplaceValue& replaceValue) noexcept {
+        replacements.emplace_back(columnName, replaceValue);
+        return *this;
+    }
+
+    inline void run() const noexcept {
+        std::ifstream in(fileName, std::ios::binary);
+        Ensure(in.is_open(), "cannot open file: " << fileName);
+        const std::string temporaryFileName = fileName + ".rewrite";
+        std::ofstream out(temporaryFileName, std::ios::binary);
+        Ensure(out.is_open(), "cannot create file: " << temporaryFileName);
+
+        std::vector<const ReplaceValue*> replacementOfColumn;
+        std::vector<std::string> columns;
+        std::string line;
+        bool isHeader = true;
+        size_t fileLine = 0;
+        size_t row = 0;
+        while (std::getline(in, line)) {
+            fileLine++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            // Ignore UTF-8 BOM
+            if (fileLine == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3);
+            if (COMMENT_POLICY::isComment(line.c_str())) {
+                out << line << '\n';
+                continue;
+            }
+            try {
+                splitColumns(line, columns);
+            } catch (Error::EscapedStringNotClosed& error) {
+                error.setFileName(fileName.c_str());
+                error.setFileLine(fileLine);
+                Ensure(false, error.what());
+            }
+            if (isHeader) {
+                for (std::string& column : columns) {
+                    const std::string name = unescape(column);
+                    const auto renamed = newColumnName.find(name);
+                    if (renamed != newColumnName.end()) column = renamed->second;
+                    const std::string& columnName = (renamed != newColumnName.end()) ? renamed->second : name;
+                    replacementOfColumn.emplace_back(nullptr);
+                    for (const std::pair<std::string, ReplaceValue>& replacement : replacements) {
+                        if (replacement.first == columnName) replacementOfColumn.back() = &replacement.second;
+                    }
+                }
+                for (const std::pair<std::string, ReplaceValue>& replacement : replacements) {
+                    bool found = false;
+                    for (const ReplaceValue* replaceValue : replacementOfColumn) {
+                        found |= (replaceValue == &replacement.second);
+                    }
+                    Ensure(found, "File " << fileName << " does not contain a column named " << replacement.first << "!");
+                }
+                isHeader = false;
+            } else {
+                for (size_t i = 0; i < columns.size() && i < replacementOfColumn.size(); i++) {
+                    if (!replacementOfColumn[i]) continue;
+                    columns[i] = (*replacementOfColumn[i])(unescape(columns[i]), row);
+                }
+                row++;
+            }
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (i > 0) out << QUOTE_POLICY::Sep;
+                out << columns[i];
+            }
+            out << '\n';
+        }
+        in.close();
+        out.close();
+        Ensure(std::rename(temporaryFileName.c_str(), fileName.c_str()) == 0, "cannot replace file: " << fileName);
+    }
+
+private:
+    inline static void splitColumns(const std::string& line, std::vector<std::string>& columns) {
+        columns.clear();
+        const char* columnBegin = line.c_str();
+        while (true) {
+            const char* columnEnd = QUOTE_POLICY::findNextColumnEnd(columnBegin);
+            columns.emplace_back(columnBegin, columnEnd);
+            if (*columnEnd == '\0') break;
+            columnBegin = columnEnd + 1;
+        }
+    }
+
+    inline static std::string unescape(std::string column) {
+        if (column.empty()) return column;
+        char* columnBegin = column.data();
+        char* columnEnd = columnBegin + column.size();
+        TRIM_POLICY::trim(columnBegin, columnEnd);
+        QUOTE_POLICY::unescape(columnBegin, columnEnd);
+        return std::string(columnBegin, columnEnd);
+    }
+
+private:
+    std::string fileName;
+    std::unordered_map<std::string, std::string> newColumnName;
+    std::vector<std::pair<std::string, ReplaceValue>> replacements;
+
+};
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace IO {
+
+    //################################################# MappedFile ##################################################################//
+    // Read-only shared memory mapping of a whole file. Processes that map the same file share its pages in the page cache.
+    class MappedFile {
+
+    public:
+        MappedFile() : address(nullptr), fileSize(0) {}
+        MappedFile(const std::string& fileName) : address(nullptr), fileSize(0) {
+            const int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+            if (fileDescriptor < 0) return;
+            struct stat fileStatus;
+            if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0) {
+                void* mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+                if (mapping != MAP_FAILED) {
+                    address = mapping;
+                    fileSize = fileStatus.st_size;
+                }
+            }
+            ::close(fileDescriptor);
+        }
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+        MappedFile(MappedFile&& other) noexcept : address(other.address), fileSize(other.fileSize) {
+            other.address = nullptr;
+            other.fileSize = 0;
+        }
+        MappedFile& operator=(MappedFile&& other) noexcept {
+            if (this == &other) return *this;
+            unmap();
+            address = other.address;
+            fileSize = other.fileSize;
+            other.address = nullptr;
+            other.fileSize = 0;
+            return *this;
+        }
+        ~MappedFile() {
+            unmap();
+        }
+
+        inline bool isOpen() const noexcept {
+            return address;
+        }
+
+        inline size_t size() const noexcept {
+            return fileSize;
+        }
+
+        // Pointer to the object at the given byte offset, the caller has to ensure the alignment.
+        template<typename T>
+        inline const T* at(const size_t offset) const noexcept {
+            return reinterpret_cast<const T*>(static_cast<const char*>(address) + offset);
+        }
+
+    private:
+        inline void unmap() noexcept {
+            if (address) munmap(address, fileSize);
+            address = nullptr;
+            fileSize = 0;
+        }
+
+    private:
+        void* address;
+        size_t fileSize;
+
+    };
+
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <type_traits>
+
+#include <omp.h>
+
+#include "File.h"
+#include "MappedFile.h"
+#include "ParserCSV.h"
+#include "../Assert.h"
+#include "../TaggedInteger.h"
+#include "../Vector/Vector.h"
+#include "../FileSystem/FileSystem.h"
+
+namespace IO {
+
+// Reads a CSV file in parallel: the file is memory mapped and split at line boundaries into one chunk per thread. Every
+// chunk is parsed independently and the results are concatenated in file order. The header and all policies behave as
+// for CSVReader. Integral and floating point columns are parsed with std::from_chars; columns that from_chars cannot
+// handle completely (e.g., a leading '+' or a decimal comma) fall back to the parser used by CSVReader.
+template<unsigned COLUMN_COUNT, class TRIM_POLICY = TrimChars<>, class QUOTE_POLICY = NoQuoteEscape<','>, class OVERFLOW_POLICY = ThrowOnOverflow, class COMMENT_POLICY = EmptyLineComment>
+class ParallelCSVReader {
+
+public:
+    // A single line of the file, whose columns are converted by parse().
+    class Row {
+        friend ParallelCSVReader;
+
+    public:
+        template<class... COLUMN_TYPE>
+        inline void parse(COLUMN_TYPE&... cols) const {
+            static_assert(sizeof...(COLUMN_TYPE) >= COLUMN_COUNT, "not enough columns specified");
+            static_assert(sizeof...(COLUMN_TYPE) <= COLUMN_COUNT, "too many columns specified");
+            parseHelper(0, cols...);
+        }
+
+    private:
+        Row(const std::array<std::vector<std::string>, COLUMN_COUNT>& columnNameAliases) :
+            columnNameAliases(columnNameAliases) {
+            std::fill(row, row + COLUMN_COUNT, nullptr);
+        }
+
+        inline void parseHelper(std::size_t) const {}
+
+        template<class T, class... COLUMN_TYPE>
+        inline void parseHelper(std::size_t r, T& t, COLUMN_TYPE&... cols) const {
+            if (row[r]) {
+                try {
+                    try {
+                        parseColumn(row[r], t);
+                    } catch (Error::WithColumnContent& error) {
+                        error.setColumnContent(row[r]);
+                        throw;
+                    }
+                } catch (Error::WithColumnName& error) {
+                    error.setColumnName(columnNameAliases[r][0].c_str());
+                    throw;
+                }
+            }
+            parseHelper(r + 1, cols...);
+        }
+
+        template<class T>
+        inline static void parseColumn(const char* column, T& x) {
+            if constexpr ((std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>) || std::is_floating_point_v<T>) {
+                const char* end = column + std::strlen(column);
+                const std::from_chars_result result = std::from_chars(column, end, x);
+                if (column != end && result.ec == std::errc() && result.ptr == end) return;
+            }
+            Detail::parse<OVERFLOW_POLICY>(column, x);
+        }
+
+        template<int TAG, typename VALUE_TYPE, VALUE_TYPE INVALID, VALUE_TYPE DEFAULT, typename... ADDITIONAL_CASTS>
+        inline static void parseColumn(const char* column, TaggedInteger<TAG, VALUE_TYPE, INVALID, DEFAULT, ADDITIONAL_CASTS...>& x) {
+            const char* end = column + std::strlen(column);
+            VALUE_TYPE y;
+            const std::from_chars_result result = std::from_chars(column, end, y);
+            if (column != end && result.ec == std::errc() && result.ptr == end) {
+                x = TaggedInteger<TAG, VALUE_TYPE, INVALID, DEFAULT, ADDITIONAL_CASTS...>(y);
+            } else {
+                Detail::parse<OVERFLOW_POLICY>(column, x);
+            }
+        }
+
+    private:
+        char* row[COLUMN_COUNT];
+        const std::array<std::vector<std::string>, COLUMN_COUNT>& columnNameAliases;
+    };
+
+public:
+    ParallelCSVReader() = delete;
+    ParallelCSVReader(const ParallelCSVReader&) = delete;
+    ParallelCSVReader& operator=(const ParallelCSVReader&) = delete;
+
+    explicit ParallelCSVReader(const std::string& fileName) :
+        fileName(fileName) {
+        Ensure(FileSystem::isFile(fileName), "cannot open file: " << fileName);
+        init();
+    }
+
+    explicit ParallelCSVReader(const std::vector<std::string>& fileNameAliases) {
+        for (const std::string& alias : fileNameAliases) {
+            if (!FileSystem::isFile(alias)) continue;
+            fileName = alias;
+            break;
+        }
+        if (fileName.empty()) {
+            Enumeration e;
+            for (const std::string& alias : fileNameAliases) {
+                e << alias << sep;
+            }
+            Ensure(false, "Cannot open any of the files: " << e);
+        }
+        init();
+    }
+
+    template<typename... T, typename = std::enable_if_t<sizeof...(T) == COLUMN_COUNT>>
+    void readHeader(const T&... columnNames) {
+        columnNameAliases = std::array<std::vector<std::string>, COLUMN_COUNT>{std::vector<std::string>{columnNames}...};
+        readHeader(IGNORE_EXTRA_COLUMN);
+    }
+
+    template<typename... T, typename = std::enable_if_t<sizeof...(T) == COLUMN_COUNT>>
+    void readHeader(const IgnoreColumn ignorePolicy, const T&... columnNames) {
+        columnNameAliases = std::array<std::vector<std::string>, COLUMN_COUNT>{std::vector<std::string>{columnNames}...};
+        readHeader(ignorePolicy);
+    }
+
+    // Calls readRow(row, entry) for every remaining line and collects the entries for which it returns true. readRow is
+    // called concurrently for lines of different chunks and must therefore not modify shared state.
+    template<typename ENTRY, typename READ_ROW>
+    inline std::vector<ENTRY> readRows(const READ_ROW& readRow, const int numberOfThreads = omp_get_max_threads()) {
+        const char* const begin = file.template at<char>(0);
+        const size_t numberOfChunks = std::max(1, numberOfThreads);
+        std::vector<size_t> chunkBegin(numberOfChunks + 1, file.size());
+        chunkBegin[0] = position;
+        for (size_t i = 1; i < numberOfChunks; i++) {
+            size_t split = std::max(chunkBegin[i - 1], position + ((file.size() - position) * i) / numberOfChunks);
+            if (split > position && split < file.size() && begin[split - 1] != '\n') {
+                const char* lineEnd = static_cast<const char*>(std::memchr(begin + split, '\n', file.size() - split));
+                split = lineEnd ? lineEnd - begin + 1 : file.size();
+            }
+            chunkBegin[i] = split;
+        }
+
+        std::vector<std::vector<ENTRY>> entries(numberOfChunks);
+        std::vector<size_t> linesOfChunk(numberOfChunks, 0);
+        std::vector<size_t> rowsOfChunk(numberOfChunks, 0);
+        std::vector<std::exception_ptr> errors(numberOfChunks);
+        #pragma omp parallel for num_threads(numberOfChunks) schedule(static, 1)
+        for (size_t chunk = 0; chunk < numberOfChunks; chunk++) {
+            Row row(columnNameAliases);
+            std::string line;
+            try {
+                for (size_t i = chunkBegin[chunk]; i < chunkBegin[chunk + 1];) {
+                    const char* lineEnd = static_cast<const char*>(std::memchr(begin + i, '\n', chunkBegin[chunk + 1] - i));
+                    const size_t end = lineEnd ? lineEnd - begin : chunkBegin[chunk + 1];
+                    line.assign(begin + i, end - i);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    i = end + 1;
+                    linesOfChunk[chunk]++;
+                    if (COMMENT_POLICY::isComment(line.c_str())) continue;
+                    Detail::parseLine<TRIM_POLICY, QUOTE_POLICY>(line.data(), row.row, colOrder);
+                    ENTRY entry;
+                    if (readRow(static_cast<const Row&>(row), entry)) entries[chunk].emplace_back(entry);
+                    rowsOfChunk[chunk]++;
+                }
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        }
+
+        size_t fileLine = headerLine;
+        for (size_t chunk = 0; chunk < numberOfChunks; chunk++) {
+            fileLine += linesOfChunk[chunk];
+            if (!errors[chunk]) continue;
+            try {
+                try {
+                    std::rethrow_exception(errors[chunk]);
+                } catch (Error::WithFileName& error) {
+                    error.setFileName(fileName.c_str());
+                    throw;
+                }
+            } catch (Error::WithFileLine& error) {
+                error.setFileLine(fileLine);
+                throw;
+            }
+        }
+
+        std::vector<ENTRY> result;
+        size_t numberOfEntries = 0;
+        for (const std::vector<ENTRY>& chunkEntries : entries) {
+            numberOfEntries += chunkEntries.size();
+        }
+        result.reserve(numberOfEntries);
+        for (size_t chunk = 0; chunk < numberOfChunks; chunk++) {
+            result.insert(result.end(), std::make_move_iterator(entries[chunk].begin()), std::make_move_iterator(entries[chunk].end()));
+            rowCount += rowsOfChunk[chunk];
+        }
+        position = file.size();
+        return result;
+    }
+
+    bool hasColumn(const std::string& name) const {
+        int nameIndex = -2;
+        for (size_t i = 0; i < COLUMN_COUNT; i++) {
+            if (Vector::contains(columnNameAliases[i], name)) {
+                nameIndex = i;
+                break;
+            }
+        }
+        return Vector::contains(colOrder, nameIndex);
+    }
+
+    // Number of rows (excluding header and comment lines) passed to readRow, regardless of its return value.
+    size_t numberOfRows() const {
+        return rowCount;
+    }
+
+    const char* getTruncatedFileName() const {
+        return fileName.c_str();
+    }
+
+private:
+    void init() noexcept {
+        file = MappedFile(fileName);
+        position = 0;
+        headerLine = 0;
+        rowCount = 0;
+        // Ignore UTF-8 BOM
+        if (file.size() >= 3 && std::memcmp(file.template at<char>(0), "\xEF\xBB\xBF", 3) == 0) position = 3;
+        colOrder.resize(COLUMN_COUNT);
+        for (unsigned i = 0; i < COLUMN_COUNT; i++) {
+            colOrder[i] = i;
+        }
+        for (unsigned i = 1; i <= COLUMN_COUNT; i++) {
+            columnNameAliases[i - 1] = std::vector<std::string>(1, "col" + std::to_string(i));
+        }
+    }
+
+    void readHeader(IgnoreColumn ignorePolicy) {
+        try {
+            std::string line;
+            do {
+                if (position >= file.size()) throw Error::HeaderMissing();
+                const char* begin = file.template at<char>(position);
+                const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', file.size() - position));
+                const size_t length = lineEnd ? lineEnd - begin : file.size() - position;
+                line.assign(begin, length);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                position += length + 1;
+                headerLine++;
+            } while (COMMENT_POLICY::isComment(line.c_str()));
+            position = std::min(position, file.size());
+            Detail::parseHeaderLine<COLUMN_COUNT, TRIM_POLICY, QUOTE_POLICY>(line.data(), colOrder, columnNameAliases, ignorePolicy);
+        } catch (Error::WithFileName& error) {
+            error.setFileName(fileName.c_str());
+            throw;
+        }
+    }
+
+private:
+    std::string fileName;
+    MappedFile file;
+    size_t position;
+    size_t headerLine;
+    size_t rowCount;
+
+    std::array<std::vector<std::string>, COLUMN_COUNT> columnNameAliases;
+
+    std::vector<int> colOrder;
+
+};
+
+}
@@ -104,6 +104,16 @@ namespace IO {
             serialize(versionId);
         }
 
+        // Version of a file format that is written without a header by the objects themselves, such that objects can
+        // choose their layout accordingly (0 by default)
+        inline size_t getFormatVersion() const noexcept {
+            return formatVersion;
+        }
+
+        inline void setFormatVersion(const size_t versionId) noexcept {
+            formatVersion = versionId;
+        }
+
     private:
         template<typename T>
         inline void serialize(const T& object) noexcept {
@@ -154,6 +164,7 @@ namespace IO {
     private:
         const std::string fileName;
         std::ofstream os;
+        size_t formatVersion{0};
 
     };
 
@@ -205,6 +216,14 @@ namespace IO {
             Ensure(fileVersionId == expectedVersionId, "Expected version " << expectedVersionId << ", but file " << fileName << " has version " << fileVersionId);
         }
 
+        inline size_t getFormatVersion() const noexcept {
+            return formatVersion;
+        }
+
+        inline void setFormatVersion(const size_t versionId) noexcept {
+            formatVersion = versionId;
+        }
+
     private:
         template<typename T>
         inline void deserialize(T& object) noexcept {
@@ -269,6 +288,7 @@ namespace IO {
     private:
         const std::string fileName;
         std::ifstream is;
+        size_t formatVersion{0};
 
     };
 
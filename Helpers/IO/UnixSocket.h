@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace IO {
+
+    //################################################# UnixSocket ##################################################################//
+    // Line based communication over a Unix domain stream socket. All operations return false on failure. Sockets are
+    // closed on exec, such that child processes do not keep connections alive.
+    class UnixSocket {
+
+    public:
+        UnixSocket(const int fileDescriptor = -1) : fileDescriptor(fileDescriptor) {}
+        UnixSocket(const UnixSocket& other) = delete;
+        UnixSocket& operator=(const UnixSocket& other) = delete;
+        UnixSocket(UnixSocket&& other) noexcept : fileDescriptor(other.fileDescriptor), buffer(std::move(other.buffer)) {
+            other.fileDescriptor = -1;
+        }
+        UnixSocket& operator=(UnixSocket&& other) noexcept {
+            if (this == &other) return *this;
+            close();
+            fileDescriptor = other.fileDescriptor;
+            buffer = std::move(other.buffer);
+            other.fileDescriptor = -1;
+            return *this;
+        }
+        ~UnixSocket() {
+            close();
+        }
+
+        // Removes a stale socket file at path. Fails with errno = EEXIST if path is any other kind of file.
+        inline static UnixSocket Listen(const std::string& path, const int backlog = 16) noexcept {
+            sockaddr_un address;
+            if (!makeAddress(path, address)) return UnixSocket();
+            struct stat status;
+            if (lstat(path.c_str(), &status) == 0) {
+                if (!S_ISSOCK(status.st_mode)) {
+                    errno = EEXIST;
+                    return UnixSocket();
+                }
+                if (unlink(path.c_str()) != 0) return UnixSocket();
+            }
+            UnixSocket result(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+            if (!result.isOpen()) return result;
+            if (bind(result.fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return UnixSocket();
+            if (listen(result.fileDescriptor, backlog) != 0) return UnixSocket();
+            return result;
+        }
+
+        inline static UnixSocket Connect(const std::string& path) noexcept {
+            sockaddr_un address;
+            if (!makeAddress(path, address)) return UnixSocket();
+            UnixSocket result(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+            if (!result.isOpen()) return result;
+            if (connect(result.fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) return UnixSocket();
+            return result;
+        }
+
+        // On failure, errno describes the reason.
+        inline UnixSocket accept() const noexcept {
+            return UnixSocket(::accept4(fileDescriptor, nullptr, nullptr, SOCK_CLOEXEC));
+        }
+
+        // Connected pair of sockets, e.g. for communicating with a child process.
+        inline static std::pair<UnixSocket, UnixSocket> Pair() noexcept {
+            int fileDescriptors[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fileDescriptors) != 0) return std::make_pair(UnixSocket(), UnixSocket());
+            return std::make_pair(UnixSocket(fileDescriptors[0]), UnixSocket(fileDescriptors[1]));
+        }
+
+        // Subsequent reads fail if no data arrives within the given time (0 = wait forever).
+        inline bool setReceiveTimeout(const int milliseconds) const noexcept {
+            timeval timeout;
+            timeout.tv_sec = milliseconds / 1000;
+            timeout.tv_usec = (milliseconds % 1000) * 1000;
+            return setsockopt(fileDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0;
+        }
+
+        inline int getFileDescriptor() const noexcept {
+            return fileDescriptor;
+        }
+
+        inline bool isOpen() const noexcept {
+            return fileDescriptor >= 0;
+        }
+
+        inline void close() noexcept {
+            if (fileDescriptor >= 0) ::close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+
+        // Reads the next line without the trailing newline. Returns false if the connection was closed before, or if the
+        // read failed (e.g. after a timeout), in which case an incomplete line is discarded.
+        inline bool readLine(std::string& line) noexcept {
+            while (true) {
+                const size_t end = buffer.find('\n');
+                if (end != std::string::npos) {
+                    line = buffer.substr(0, end);
+                    buffer.erase(0, end + 1);
+                    return true;
+                }
+                char data[4096];
+                const ssize_t size = recv(fileDescriptor, data, sizeof(data), 0);
+                if (size < 0) {
+                    buffer.clear();
+                    return false;
+                }
+                if (size == 0) {
+                    if (buffer.empty()) return false;
+                    line = std::move(buffer);
+                    buffer.clear();
+                    return true;
+                }
+                buffer.append(data, size);
+            }
+        }
+
+        // Fails silently (without SIGPIPE) if the peer has closed the connection.
+        inline bool writeLine(const std::string& line) const noexcept {
+            const std::string data = line + "\n";
+            size_t written = 0;
+            while (written < data.size()) {
+                const ssize_t size = send(fileDescriptor, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+                if (size <= 0) return false;
+                written += size;
+            }
+            return true;
+        }
+
+    private:
+        inline static bool makeAddress(const std::string& path, sockaddr_un& address) noexcept {
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(address.sun_path)) {
+                errno = ENAMETOOLONG;
+                return false;
+            }
+            std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+            return true;
+        }
+
+    private:
+        int fileDescriptor;
+        std::string buffer;
+
+    };
+
+}
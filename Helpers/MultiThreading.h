@@ -5,6 +5,9 @@
 #include <vector>
 #include <thread>
 #include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 #include "Assert.h"
 
@@ -163,3 +166,69 @@ public:
     size_t pinMultiplier;
 
 };
+
+// Persistent thread that executes one task at a time, which avoids creating a thread for every task. The thread is
+// pinned to coreId (if it is not negative) and joined on destruction.
+class HelperThread {
+
+public:
+    HelperThread(const int coreId = -1) :
+        hasTask(false),
+        terminate(false),
+        thread([this, coreId]() {
+            if (coreId >= 0) pinThreadToCoreId(coreId);
+            work();
+        }) {
+    }
+    HelperThread(const HelperThread&) = delete;
+    HelperThread& operator=(const HelperThread&) = delete;
+
+    ~HelperThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            terminate = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+
+    // Starts the task, the previous task has to be finished (see wait()).
+    inline void run(std::function<void()> function) noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            AssertMsg(!hasTask, "The previous task has not been finished!");
+            task = std::move(function);
+            hasTask = true;
+        }
+        condition.notify_all();
+    }
+
+    inline void wait() noexcept {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() {return !hasTask;});
+    }
+
+private:
+    inline void work() noexcept {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [&]() {return hasTask || terminate;});
+            if (!hasTask) return;
+            lock.unlock();
+            task();
+            lock.lock();
+            task = nullptr;
+            hasTask = false;
+            condition.notify_all();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<void()> task;
+    bool hasTask;
+    bool terminate;
+    std::thread thread;
+
+};
@@ -20,7 +20,19 @@ int main(int argc, char** argv) {
 
     ::Shell::Shell shell;
     new ParseCSAFromCSV(shell);
+    new WriteMappedCSA(shell);
     new GroupAssignment(shell);
+    new PrepareAssignment(shell);
+    new GroupAssignmentSweep(shell);
+    new MultiClassAssignment(shell);
+    new ScenarioBatch(shell);
+    new WalkingRadiusReport(shell);
+    new FootpathRelaxationBenchmark(shell);
+    new PATEngineBenchmark(shell);
+    new DecisionModelBenchmark(shell);
+    new TimetableChangeImpact(shell);
+    new AssignmentServer(shell);
+    new SubmitAssignmentJob(shell);
     shell.run();
     return 0;
 }
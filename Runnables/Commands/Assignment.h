@@ -1,18 +1,68 @@
 #pragma once
 
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "../../Shell/Shell.h"
 
+#include "../../Algorithms/DecisionModels/Configurable.h"
 #include "../../Algorithms/DecisionModels/Kirchhoff.h"
 #include "../../Algorithms/DecisionModels/Linear.h"
 #include "../../Algorithms/DecisionModels/Logit.h"
 #include "../../Algorithms/DecisionModels/Optimal.h"
 #include "../../Algorithms/DecisionModels/RelativeLogit.h"
+#include "../../Algorithms/Assignment/AssignmentBundle.h"
 #include "../../Algorithms/Assignment/GroupAssignment.h"
 #include "../../Algorithms/Assignment/Profiler.h"
+#include "../../Algorithms/Assignment/TimetableChangeImpact.h"
+#include "../../Algorithms/Assignment/TripBasedPATs.h"
 #include "../../DataStructures/Assignment/Settings.h"
 
+#include "../../Helpers/Meta.h"
+#include "../../Helpers/IO/UnixSocket.h"
+
 using namespace Shell;
 
+// Calls function(Meta::ID<APPORTIONMENT_TYPE>()) for the group assignment with the configurable decision model and the
+// profiler of the settings.
+template<bool USE_TRANSFER_BUFFER_TIMES, typename FUNCTION>
+inline void chooseConfigurableAssignment(const Assignment::Settings& settings, const FUNCTION& function) noexcept {
+    switch (settings.profilerType) {
+        case 1: {
+            function(Meta::ID<Assignment::GroupAssignment<DecisionModels::Configurable, Assignment::TimeProfiler, USE_TRANSFER_BUFFER_TIMES>>());
+            break;
+        }
+        case 2: {
+            function(Meta::ID<Assignment::GroupAssignment<DecisionModels::Configurable, Assignment::DecisionProfiler, USE_TRANSFER_BUFFER_TIMES>>());
+            break;
+        }
+        default: {
+            function(Meta::ID<Assignment::GroupAssignment<DecisionModels::Configurable, Assignment::NoProfiler, USE_TRANSFER_BUFFER_TIMES>>());
+            break;
+        }
+    }
+}
+
+template<typename FUNCTION>
+inline void chooseConfigurableAssignment(const Assignment::Settings& settings, const bool useTransferBufferTimes, const FUNCTION& function) noexcept {
+    if (useTransferBufferTimes) {
+        chooseConfigurableAssignment<true>(settings, function);
+    } else {
+        chooseConfigurableAssignment<false>(settings, function);
+    }
+}
+
 class ParseCSAFromCSV : public ParameterizedCommand {
 
 public:
@@ -22,20 +72,26 @@ public:
         addParameter("Output file");
         addParameter("Make transfers bidirectional?", "false");
         addParameter("Repair files?", "true");
+        addParameter("Max walking time", "-1");
+        addParameter("Max transfer edges per vertex", "-1");
     }
 
     virtual void execute() noexcept {
         const std::string csvDirectory = getParameter("Input directory");
         const bool makeBidirectional = getParameter<bool>("Make transfers bidirectional?");
         const bool repairFiles = getParameter<bool>("Repair files?");
+        const int maxWalkingTime = getParameter<int>("Max walking time");
+        const int maxEdgesPerVertex = getParameter<int>("Max transfer edges per vertex");
 
         if (repairFiles) {
             CSA::Data::RepairFiles(csvDirectory);
         }
+        const int walkingTimeBound = (maxWalkingTime < 0) ? intMax : maxWalkingTime;
+        const size_t edgeBound = (maxEdgesPerVertex < 0) ? size_t(-1) : size_t(maxEdgesPerVertex);
         if (makeBidirectional) {
-            parseData(CSA::Data::FromCSVwithZones<false>(csvDirectory));
+            parseData(CSA::Data::FromCSVwithZones<false>(csvDirectory, walkingTimeBound, edgeBound));
         } else {
-            parseData(CSA::Data::FromCSVwithZones<true>(csvDirectory));
+            parseData(CSA::Data::FromCSVwithZones<true>(csvDirectory, walkingTimeBound, edgeBound));
         }
     }
 
@@ -48,6 +104,23 @@ private:
 
 };
 
+class WriteMappedCSA : public ParameterizedCommand {
+
+public:
+    WriteMappedCSA(BasicShell& shell) :
+        ParameterizedCommand(shell, "writeMappedCSA", "Converts a CSA binary into the fixed-layout format that is loaded via a read-only memory mapping. All commands accept both formats as CSA binary.") {
+        addParameter("CSA binary");
+        addParameter("Output file");
+    }
+
+    virtual void execute() noexcept {
+        const CSA::Data data = CSA::Data::FromBinary(getParameter("CSA binary"));
+        data.printInfo();
+        data.serializeMapped(getParameter("Output file"));
+    }
+
+};
+
 class GroupAssignment : public ParameterizedCommand {
 
 public:
@@ -63,6 +136,12 @@ public:
         addParameter("Use transfer buffer times", "false");
         addParameter("Demand output file", "-");
         addParameter("Demand output size", "-1");
+        addParameter("Pipeline PAT computation", "false");
+        addParameter("PAT helper core offset", "1");
+        addParameter("PAT cache directory", "-");
+        addParameter("Incremental result directory", "-");
+        addParameter("Monte Carlo replications", "1");
+        addParameter("Assignment bundle", "-");
     }
 
     virtual void execute() noexcept {
@@ -134,28 +213,58 @@ private:
         const int pinMultiplier = getParameter<int>("Thread offset");
         const std::string demandOutputFileName = getParameter("Demand output file");
         const size_t demandOutputSize = getParameter<size_t>("Demand output size");
+        const bool usePipeline = getParameter<bool>("Pipeline PAT computation");
+        const int helperCoreOffset = getParameter<int>("PAT helper core offset");
+        const std::string patCacheDirectory = getParameter("PAT cache directory");
+        const std::string incrementalResultDirectory = getParameter("Incremental result directory");
+        const size_t numberOfReplications = getParameter<size_t>("Monte Carlo replications");
+        const std::string bundleFileName = getParameter("Assignment bundle");
+        // The incremental, replication and capacity-constrained modes are mutually exclusive and do not pipeline the PAT computation.
+        if (settings.capacityIterations > 0 && (incrementalResultDirectory != "-" || numberOfReplications > 1)) {
+            shell.error("Capacity iterations cannot be combined with an incremental result directory or Monte Carlo replications!");
+            return;
+        }
+        if (usePipeline && (incrementalResultDirectory != "-" || numberOfReplications > 1 || settings.capacityIterations > 0)) {
+            shell.error("Pipeline PAT computation cannot be combined with an incremental result directory, Monte Carlo replications or capacity iterations!");
+            return;
+        }
 
-        CSA::Data csaData = CSA::Data::FromBinary(csaFileName);
-        csaData.sortConnectionsAscendingByDepartureTime();
+        // With a bundle, the CSA binary, the demand file and the demand multiplier are taken from the bundle.
+        Assignment::AssignmentBundle bundle = (bundleFileName == "-") ? Assignment::AssignmentBundle(csaFileName, demandFileName, demandMultiplier, settings) : Assignment::AssignmentBundle(bundleFileName, settings);
+        const std::string networkFileName = (bundleFileName == "-") ? csaFileName : Assignment::AssignmentBundle::getCSAFileName(bundleFileName);
+        const CSA::Data& csaData = bundle.data;
         csaData.printInfo();
         csaData.transferGraph.printAnalysis();
         std::cout << std::endl;
-        CSA::TransferGraph reverseGraph = csaData.transferGraph;
-        reverseGraph.revert();
-        AccumulatedVertexDemand originalDemand = AccumulatedVertexDemand::FromZoneCSV(demandFileName, csaData, reverseGraph, demandMultiplier);
-        AccumulatedVertexDemand demand = originalDemand;
+        const AccumulatedVertexDemand& originalDemand = bundle.originalDemand;
+        const AccumulatedVertexDemand& demand = bundle.demand;
 
-        if (settings.demandIntervalSplitTime >= 0) {
-            demand.discretize(settings.demandIntervalSplitTime, settings.keepDemandIntervals, settings.includeIntervalBorder);
+        APPORTIONMENT_TYPE ma(csaData, bundle.reverseGraph, settings);
+        ma.usePreparedNetwork(&bundle.preparedNetwork);
+        if (patCacheDirectory != "-") {
+            ma.enablePATCache(patCacheDirectory, networkFileName);
         }
-        APPORTIONMENT_TYPE ma(csaData, reverseGraph, settings);
         Timer timer;
-        if (numThreads > 0) {
+        if (incrementalResultDirectory != "-") {
+            const size_t recomputedDestinations = ma.runIncremental(bundle.demandByDestination, incrementalResultDirectory, networkFileName, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+            std::cout << "Recomputed " << String::prettyInt(recomputedDestinations) << " destinations." << std::endl;
+        } else if (numberOfReplications > 1) {
+            ma.runReplications(bundle.demandByDestination, numberOfReplications, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+            std::cout << "Computed " << numberOfReplications << " Monte Carlo replications." << std::endl;
+        } else if (settings.capacityIterations > 0) {
+            const std::vector<size_t> assignedDestinations = ma.runCapacityConstrained(bundle.demandByDestination, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+            std::cout << "Capacity-constrained assignment with " << (assignedDestinations.size() - 1) << " reassignments, assigned destinations per iteration:";
+            for (const size_t count : assignedDestinations) {
+                std::cout << " " << String::prettyInt(count);
+            }
+            std::cout << std::endl;
+        } else if (numThreads > 0) {
             const int numCores(numberOfCores());
             std::cout << "Using " << numThreads << " threads on " << numCores << " cores!" << std::endl;
-            ma.run(demand, numThreads, pinMultiplier);
+            if (usePipeline) std::cout << "Using " << numThreads << " additional PAT helper threads (core offset " << helperCoreOffset << ")!" << std::endl;
+            ma.run(bundle.demandByDestination, numThreads, pinMultiplier, usePipeline, helperCoreOffset);
         } else {
-            ma.run(demand);
+            ma.run(bundle.demandByDestination, 1, 1, usePipeline, helperCoreOffset);
         }
 
         std::cout << "done in " << String::msToString(timer.elapsedMilliseconds()) << "." << std::endl;
@@ -181,3 +290,1133 @@ private:
         ma.writeAssignedJourneys(FileSystem::ensureExtension(outputFileName, "_journeys.csv"), demand);
     }
 };
+
+class PrepareAssignment : public ParameterizedCommand {
+
+public:
+    PrepareAssignment(BasicShell& shell) :
+        ParameterizedCommand(shell, "prepareAssignment", "Writes the sorted network, the reverse graph, the prepared network and the split demand to <Assignment bundle>.*, which can be passed to groupAssignment instead of the CSA binary and the demand file.", "Settings file:", "    Only the demand settings are used, groupAssignment requires the same demand settings") {
+        addParameter("Settings file");
+        addParameter("CSA binary");
+        addParameter("Demand file");
+        addParameter("Assignment bundle");
+        addParameter("Demand multiplier", "1");
+    }
+
+    virtual void execute() noexcept {
+        ConfigFile configFile(getParameter("Settings file"), true);
+        const Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+        const std::string bundleFileName = getParameter("Assignment bundle");
+
+        Timer timer;
+        const Assignment::AssignmentBundle bundle(getParameter("CSA binary"), getParameter("Demand file"), getParameter<size_t>("Demand multiplier"), settings);
+        bundle.data.printInfo();
+        std::cout << "Prepared " << String::prettyInt(bundle.demandByDestination.size()) << " destinations and " << String::prettyInt(bundle.preparedNetwork.stopReverseGraph.numEdges()) << " stop transfer edges in " << String::msToString(timer.elapsedMilliseconds()) << "." << std::endl;
+        bundle.serialize(bundleFileName);
+    }
+};
+
+class GroupAssignmentSweep : public ParameterizedCommand {
+
+public:
+    GroupAssignmentSweep(BasicShell& shell) :
+        ParameterizedCommand(shell, "groupAssignmentSweep", "Computes transit assignments for several settings files that share the PAT settings (e.g. for decision model calibration). The PATs are computed only once per destination.", "Settings files:", "    Comma separated list, the output of the i-th settings file is written to <Output file>_<i>") {
+        addParameter("Settings files");
+        addParameter("CSA binary");
+        addParameter("Demand file");
+        addParameter("Output file");
+        addParameter("Demand multiplier", "1");
+        addParameter("Num threads", "0");
+        addParameter("Thread offset", "1");
+        addParameter("Use transfer buffer times", "false");
+        addParameter("PAT cache directory", "-");
+    }
+
+    virtual void execute() noexcept {
+        std::vector<Assignment::Settings> settings;
+        for (const std::string& settingsFileName : String::split(getParameter("Settings files"), ',')) {
+            ConfigFile configFile(settingsFileName, true);
+            settings.emplace_back(configFile);
+            configFile.writeIfModified(false);
+        }
+        if (settings.empty()) {
+            shell.error("No settings files specified!");
+            return;
+        }
+        for (const Assignment::Settings& s : settings) {
+            if (!s.hasSamePATs(settings[0]) || !s.hasSameDemand(settings[0])) {
+                shell.error("All settings files must have the same PAT settings (transferCosts, walkingCosts, waitingCosts, maxDelay) and demand settings!");
+                return;
+            }
+            if (s.capacityIterations > 0) {
+                shell.error("Capacity iterations are not supported by groupAssignmentSweep!");
+                return;
+            }
+        }
+        chooseConfigurableAssignment(settings[0], getParameter<bool>("Use transfer buffer times"), [&](const auto type) {
+            computeApportionments<typename decltype(type)::Type>(settings);
+        });
+    }
+
+private:
+    template<typename APPORTIONMENT_TYPE>
+    inline void computeApportionments(const std::vector<Assignment::Settings>& settings) {
+        const std::string csaFileName = getParameter("CSA binary");
+        const std::string demandFileName = getParameter("Demand file");
+        const std::string outputFileName = getParameter("Output file");
+        const size_t demandMultiplier = getParameter<size_t>("Demand multiplier");
+        const int numThreads = getParameter<int>("Num threads");
+        const int pinMultiplier = getParameter<int>("Thread offset");
+        const std::string patCacheDirectory = getParameter("PAT cache directory");
+
+        const CSA::Data csaData = Assignment::AssignmentBundle::SortedData(csaFileName);
+        csaData.printInfo();
+        std::cout << std::endl;
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(csaData);
+        const AccumulatedVertexDemand originalDemand = AccumulatedVertexDemand::FromZoneCSV(demandFileName, csaData, reverseGraph, demandMultiplier);
+        const AccumulatedVertexDemand demand = Assignment::AssignmentBundle::DiscretizedDemand(originalDemand, settings[0]);
+
+        std::vector<APPORTIONMENT_TYPE> assignments;
+        assignments.reserve(settings.size());
+        for (const Assignment::Settings& s : settings) {
+            assignments.emplace_back(csaData, reverseGraph, s);
+        }
+        if (patCacheDirectory != "-") {
+            assignments[0].enablePATCache(patCacheDirectory, csaFileName);
+        }
+        Timer timer;
+        if (numThreads > 0) {
+            std::cout << "Using " << numThreads << " threads on " << numberOfCores() << " cores!" << std::endl;
+            APPORTIONMENT_TYPE::runSweep(assignments, demand, numThreads, pinMultiplier);
+        } else {
+            APPORTIONMENT_TYPE::runSweep(assignments, demand);
+        }
+        std::cout << "done in " << String::msToString(timer.elapsedMilliseconds()) << " (" << assignments.size() << " settings)." << std::endl;
+
+        for (size_t i = 0; i < assignments.size(); i++) {
+            const std::string fileName = outputFileName + "_" + std::to_string(i);
+            std::cout << std::endl << "Settings " << i << ":" << std::endl;
+            std::cout << "   removed cycle connections: " << String::prettyInt(assignments[i].getRemovedCycleConnections()) << std::endl;
+            std::cout << "   removed cycles: " << String::prettyInt(assignments[i].getRemovedCycles()) << std::endl;
+            assignments[i].getProfiler().printStatistics();
+            assignments[i].printStatistics(originalDemand, fileName);
+            assignments[i].writeConnectionsWithLoad(FileSystem::ensureExtension(fileName, "_connections.csv"));
+            assignments[i].writeAssignment(FileSystem::ensureExtension(fileName, "_assignment.csv"));
+            assignments[i].writeGroups(FileSystem::ensureExtension(fileName, "_groups.csv"));
+            assignments[i].writeAssignedJourneys(FileSystem::ensureExtension(fileName, "_journeys.csv"), demand);
+        }
+    }
+};
+
+class MultiClassAssignment : public ParameterizedCommand {
+
+public:
+    MultiClassAssignment(BasicShell& shell) :
+        ParameterizedCommand(shell, "multiClassAssignment", "Computes transit assignments for several user classes, each with its own settings file and demand file, in a single run on the same network. Classes with the same PAT settings share the PAT computation.", "Settings files:", "    Comma separated list, the output of the i-th class is written to <Output file>_<i>", "Demand files:", "    Comma separated list with one file per class, or a single file for all classes") {
+        addParameter("Settings files");
+        addParameter("CSA binary");
+        addParameter("Demand files");
+        addParameter("Output file");
+        addParameter("Demand multiplier", "1");
+        addParameter("Num threads", "0");
+        addParameter("Thread offset", "1");
+        addParameter("Use transfer buffer times", "false");
+        addParameter("PAT cache directory", "-");
+    }
+
+    virtual void execute() noexcept {
+        std::vector<Assignment::Settings> settings;
+        for (const std::string& settingsFileName : String::split(getParameter("Settings files"), ',')) {
+            ConfigFile configFile(settingsFileName, true);
+            settings.emplace_back(configFile);
+            configFile.writeIfModified(false);
+        }
+        if (settings.empty()) {
+            shell.error("No settings files specified!");
+            return;
+        }
+        std::vector<std::string> demandFileNames = String::split(getParameter("Demand files"), ',');
+        if (demandFileNames.size() == 1) demandFileNames.resize(settings.size(), demandFileNames[0]);
+        if (demandFileNames.size() != settings.size()) {
+            shell.error("Number of demand files (" + std::to_string(demandFileNames.size()) + ") does not match the number of settings files (" + std::to_string(settings.size()) + ")!");
+            return;
+        }
+        for (const Assignment::Settings& s : settings) {
+            if (s.capacityIterations > 0) {
+                shell.error("Capacity iterations are not supported by multiClassAssignment!");
+                return;
+            }
+        }
+        chooseConfigurableAssignment(settings[0], getParameter<bool>("Use transfer buffer times"), [&](const auto type) {
+            computeApportionments<typename decltype(type)::Type>(settings, demandFileNames);
+        });
+    }
+
+private:
+    template<typename APPORTIONMENT_TYPE>
+    inline void computeApportionments(const std::vector<Assignment::Settings>& settings, const std::vector<std::string>& demandFileNames) {
+        const std::string csaFileName = getParameter("CSA binary");
+        const std::string outputFileName = getParameter("Output file");
+        const size_t demandMultiplier = getParameter<size_t>("Demand multiplier");
+        const int numThreads = getParameter<int>("Num threads");
+        const int pinMultiplier = getParameter<int>("Thread offset");
+        const std::string patCacheDirectory = getParameter("PAT cache directory");
+
+        const CSA::Data csaData = Assignment::AssignmentBundle::SortedData(csaFileName);
+        csaData.printInfo();
+        std::cout << std::endl;
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(csaData);
+
+        std::vector<AccumulatedVertexDemand> originalDemands;
+        std::vector<AccumulatedVertexDemand> demands;
+        std::vector<APPORTIONMENT_TYPE> assignments;
+        assignments.reserve(settings.size());
+        for (size_t i = 0; i < settings.size(); i++) {
+            originalDemands.emplace_back(AccumulatedVertexDemand::FromZoneCSV(demandFileNames[i], csaData, reverseGraph, demandMultiplier));
+            demands.emplace_back(Assignment::AssignmentBundle::DiscretizedDemand(originalDemands.back(), settings[i]));
+            assignments.emplace_back(csaData, reverseGraph, settings[i]);
+            if (patCacheDirectory != "-") {
+                assignments.back().enablePATCache(patCacheDirectory, csaFileName);
+            }
+        }
+        Timer timer;
+        if (numThreads > 0) {
+            std::cout << "Using " << numThreads << " threads on " << numberOfCores() << " cores!" << std::endl;
+            APPORTIONMENT_TYPE::runMultiClass(assignments, demands, numThreads, pinMultiplier);
+        } else {
+            APPORTIONMENT_TYPE::runMultiClass(assignments, demands);
+        }
+        std::cout << "done in " << String::msToString(timer.elapsedMilliseconds()) << " (" << assignments.size() << " classes)." << std::endl;
+
+        for (size_t i = 0; i < assignments.size(); i++) {
+            const std::string fileName = outputFileName + "_" + std::to_string(i);
+            std::cout << std::endl << "Class " << i << ":" << std::endl;
+            std::cout << "   removed cycle connections: " << String::prettyInt(assignments[i].getRemovedCycleConnections()) << std::endl;
+            std::cout << "   removed cycles: " << String::prettyInt(assignments[i].getRemovedCycles()) << std::endl;
+            assignments[i].getProfiler().printStatistics();
+            assignments[i].printStatistics(originalDemands[i], fileName);
+            assignments[i].writeConnectionsWithLoad(FileSystem::ensureExtension(fileName, "_connections.csv"));
+            assignments[i].writeAssignment(FileSystem::ensureExtension(fileName, "_assignment.csv"));
+            assignments[i].writeGroups(FileSystem::ensureExtension(fileName, "_groups.csv"));
+            assignments[i].writeAssignedJourneys(FileSystem::ensureExtension(fileName, "_journeys.csv"), demands[i]);
+        }
+
+        APPORTIONMENT_TYPE::writeConnectionsWithLoad(assignments, FileSystem::ensureExtension(outputFileName, "_connections.csv"));
+    }
+};
+
+class ScenarioBatch : public ParameterizedCommand {
+
+private:
+    struct Scenario {
+        std::string settingsFileName;
+        size_t demandMultiplier;
+        std::string outputPrefix;
+        Assignment::Settings settings;
+        double demandTime{0};
+        double assignmentTime{0};
+        double outputTime{0};
+    };
+
+    // Demand for one demand multiplier and one combination of demand settings, discretized and split by destination.
+    struct PreparedDemand {
+        size_t demandMultiplier;
+        Assignment::Settings settings;
+        AccumulatedVertexDemand demand;
+        std::unique_ptr<SplitDemand<AccumulatedVertexDemand::Entry>> demandByDestination;
+    };
+
+    // Network and demand shared by all scenarios of one execution, it does not outlive execute().
+    struct Batch {
+        Batch(const CSA::Data& data, const CSA::TransferGraph& reverseGraph) :
+            data(data),
+            reverseGraph(reverseGraph) {
+        }
+        const CSA::Data& data;
+        const CSA::TransferGraph& reverseGraph;
+        Map<size_t, AccumulatedVertexDemand> originalDemands;
+        std::vector<std::unique_ptr<PreparedDemand>> preparedDemands;
+    };
+
+public:
+    ScenarioBatch(BasicShell& shell) :
+        ParameterizedCommand(shell, "scenarioBatch", "Loads a network and a demand file once and computes an assignment for every scenario of a scenario file. Demand that has been discretized and split for one scenario is reused by all scenarios with the same demand multiplier and demand settings.", "Scenario file:", "    CSV file with the columns settings_file, demand_multiplier, output_prefix") {
+        addParameter("CSA binary");
+        addParameter("Demand file");
+        addParameter("Scenario file");
+        addParameter("Num threads", "0");
+        addParameter("Thread offset", "1");
+        addParameter("Use transfer buffer times", "false");
+    }
+
+    virtual void execute() noexcept {
+        std::vector<Scenario> scenarios;
+        IO::CSVReader<3, IO::TrimChars<>, IO::DoubleQuoteEscape<',','"'>> in(getParameter("Scenario file"));
+        in.readHeader(IO::IGNORE_EXTRA_COLUMN, "settings_file", "demand_multiplier", "output_prefix");
+        Scenario scenario;
+        while (in.readRow(scenario.settingsFileName, scenario.demandMultiplier, scenario.outputPrefix)) {
+            scenarios.emplace_back(scenario);
+        }
+        if (scenarios.empty()) {
+            shell.error("The scenario file contains no scenarios!");
+            return;
+        }
+        for (Scenario& s : scenarios) {
+            ConfigFile configFile(s.settingsFileName, true);
+            s.settings = Assignment::Settings(configFile);
+            configFile.writeIfModified(false);
+            if (s.settings.capacityIterations > 0) {
+                shell.error("Capacity iterations are not supported by scenarioBatch (scenario " + s.outputPrefix + ")!");
+                return;
+            }
+        }
+
+        const CSA::Data data = Assignment::AssignmentBundle::SortedData(getParameter("CSA binary"));
+        data.printInfo();
+        std::cout << std::endl;
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(data);
+        Batch batch(data, reverseGraph);
+
+        Timer batchTimer;
+        for (Scenario& s : scenarios) {
+            std::cout << "Scenario " << s.outputPrefix << " (" << s.settingsFileName << ", demand multiplier " << s.demandMultiplier << ")" << std::endl;
+            chooseConfigurableAssignment(s.settings, getParameter<bool>("Use transfer buffer times"), [&](const auto type) {
+                computeApportionment<typename decltype(type)::Type>(batch, s, s.settings);
+            });
+        }
+
+        std::cout << std::endl << std::left << std::setw(32) << "Scenario" << std::right << std::setw(12) << "Multiplier" << std::setw(14) << "Demand" << std::setw(14) << "Assignment" << std::setw(14) << "Output" << std::setw(14) << "Total" << std::endl;
+        for (const Scenario& s : scenarios) {
+            std::cout << std::left << std::setw(32) << s.outputPrefix << std::right << std::setw(12) << s.demandMultiplier << std::setw(14) << String::msToString(s.demandTime) << std::setw(14) << String::msToString(s.assignmentTime) << std::setw(14) << String::msToString(s.outputTime) << std::setw(14) << String::msToString(s.demandTime + s.assignmentTime + s.outputTime) << std::endl;
+        }
+        std::cout << "Computed " << scenarios.size() << " scenarios in " << String::msToString(batchTimer.elapsedMilliseconds()) << "." << std::endl;
+    }
+
+private:
+    template<typename APPORTIONMENT_TYPE>
+    inline void computeApportionment(Batch& batch, Scenario& scenario, const Assignment::Settings& settings) noexcept {
+        const int numThreads = getParameter<int>("Num threads");
+        const int pinMultiplier = getParameter<int>("Thread offset");
+        APPORTIONMENT_TYPE ma(batch.data, batch.reverseGraph, settings);
+
+        Timer timer;
+        const PreparedDemand& prepared = getPreparedDemand(batch, scenario.demandMultiplier, settings, ma);
+        SplitDemand<AccumulatedVertexDemand::Entry> demandByDestination = *prepared.demandByDestination;
+        scenario.demandTime = timer.elapsedMilliseconds();
+
+        timer.restart();
+        ma.run(demandByDestination, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+        scenario.assignmentTime = timer.elapsedMilliseconds();
+
+        timer.restart();
+        ma.printStatistics(batch.originalDemands.at(scenario.demandMultiplier), scenario.outputPrefix);
+        ma.writeConnectionsWithLoad(FileSystem::ensureExtension(scenario.outputPrefix, "_connections.csv"));
+        ma.writeAssignment(FileSystem::ensureExtension(scenario.outputPrefix, "_assignment.csv"));
+        ma.writeGroups(FileSystem::ensureExtension(scenario.outputPrefix, "_groups.csv"));
+        ma.writeAssignedJourneys(FileSystem::ensureExtension(scenario.outputPrefix, "_journeys.csv"), prepared.demand);
+        scenario.outputTime = timer.elapsedMilliseconds();
+    }
+
+    template<typename APPORTIONMENT_TYPE>
+    inline const PreparedDemand& getPreparedDemand(Batch& batch, const size_t demandMultiplier, const Assignment::Settings& settings, const APPORTIONMENT_TYPE& ma) noexcept {
+        for (const std::unique_ptr<PreparedDemand>& prepared : batch.preparedDemands) {
+            if (prepared->demandMultiplier == demandMultiplier && prepared->settings.hasSameDemand(settings)) return *prepared;
+        }
+        if (!batch.originalDemands.contains(demandMultiplier)) {
+            batch.originalDemands.insert(demandMultiplier, AccumulatedVertexDemand::FromZoneCSV(getParameter("Demand file"), batch.data, batch.reverseGraph, demandMultiplier));
+        }
+        batch.preparedDemands.emplace_back(std::make_unique<PreparedDemand>());
+        PreparedDemand& prepared = *batch.preparedDemands.back();
+        prepared.demandMultiplier = demandMultiplier;
+        prepared.settings = settings;
+        prepared.demand = Assignment::AssignmentBundle::DiscretizedDemand(batch.originalDemands.at(demandMultiplier), settings);
+        prepared.demandByDestination = std::make_unique<SplitDemand<AccumulatedVertexDemand::Entry>>(ma.splitDemand(prepared.demand));
+        return prepared;
+    }
+};
+
+class WalkingRadiusReport : public ParameterizedCommand {
+
+private:
+    struct Radius {
+        int maxWalkingTime;
+        size_t numberOfEdges{0};
+        double parseTime{0};
+        double assignmentTime{0};
+        size_t unassignedGroups{0};
+    };
+
+public:
+    WalkingRadiusReport(BasicShell& shell) :
+        ParameterizedCommand(shell, "walkingRadiusReport", "Parses a CSA network from .csv files once for every maximum walking time and reports the size of the resulting transfer graph and the time of an assignment on it.", "Max walking times:", "    Comma separated list, -1 means no limit") {
+        addParameter("Input directory");
+        addParameter("Settings file");
+        addParameter("Demand file");
+        addParameter("Output file");
+        addParameter("Max walking times", "-1");
+        addParameter("Max transfer edges per vertex", "-1");
+        addParameter("Make transfers bidirectional?", "false");
+        addParameter("Demand multiplier", "1");
+        addParameter("Num threads", "0");
+        addParameter("Thread offset", "1");
+        addParameter("Use transfer buffer times", "false");
+    }
+
+    virtual void execute() noexcept {
+        std::vector<Radius> radii;
+        for (const std::string& maxWalkingTime : String::split(getParameter("Max walking times"), ',')) {
+            radii.emplace_back(Radius{String::lexicalCast<int>(maxWalkingTime)});
+        }
+        ConfigFile configFile(getParameter("Settings file"), true);
+        const Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+
+        for (Radius& radius : radii) {
+            std::cout << "Max walking time " << radius.maxWalkingTime << std::endl;
+            chooseConfigurableAssignment(settings, getParameter<bool>("Use transfer buffer times"), [&](const auto type) {
+                computeApportionment<typename decltype(type)::Type>(radius, settings);
+            });
+        }
+
+        IO::OFStream file(getParameter("Output file"));
+        file << "maxWalkingTime,transferEdges,parseTime,assignmentTime,unassignedGroups\n";
+        std::cout << std::endl << std::right << std::setw(16) << "Walking time" << std::setw(16) << "Edges" << std::setw(14) << "Parse" << std::setw(14) << "Assignment" << std::setw(12) << "Unassigned" << std::endl;
+        for (const Radius& radius : radii) {
+            file << radius.maxWalkingTime << "," << radius.numberOfEdges << "," << radius.parseTime << "," << radius.assignmentTime << "," << radius.unassignedGroups << "\n";
+            std::cout << std::setw(16) << radius.maxWalkingTime << std::setw(16) << String::prettyInt(radius.numberOfEdges) << std::setw(14) << String::msToString(radius.parseTime) << std::setw(14) << String::msToString(radius.assignmentTime) << std::setw(12) << String::prettyInt(radius.unassignedGroups) << std::endl;
+        }
+    }
+
+private:
+    template<typename APPORTIONMENT_TYPE>
+    inline void computeApportionment(Radius& radius, const Assignment::Settings& settings) noexcept {
+        const std::string csvDirectory = getParameter("Input directory");
+        const int maxEdgesPerVertex = getParameter<int>("Max transfer edges per vertex");
+        const size_t demandMultiplier = getParameter<size_t>("Demand multiplier");
+        const int numThreads = getParameter<int>("Num threads");
+        const int pinMultiplier = getParameter<int>("Thread offset");
+        const int walkingTimeBound = (radius.maxWalkingTime < 0) ? intMax : radius.maxWalkingTime;
+        const size_t edgeBound = (maxEdgesPerVertex < 0) ? size_t(-1) : size_t(maxEdgesPerVertex);
+
+        Timer timer;
+        CSA::Data data = getParameter<bool>("Make transfers bidirectional?") ? CSA::Data::FromCSVwithZones<false>(csvDirectory, walkingTimeBound, edgeBound) : CSA::Data::FromCSVwithZones<true>(csvDirectory, walkingTimeBound, edgeBound);
+        radius.parseTime = timer.elapsedMilliseconds();
+        radius.numberOfEdges = data.transferGraph.numEdges();
+        data.sortConnectionsAscendingByDepartureTime();
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(data);
+        const AccumulatedVertexDemand demand = Assignment::AssignmentBundle::DiscretizedDemand(AccumulatedVertexDemand::FromZoneCSV(getParameter("Demand file"), data, reverseGraph, demandMultiplier), settings);
+
+        APPORTIONMENT_TYPE ma(data, reverseGraph, settings);
+        SplitDemand<AccumulatedVertexDemand::Entry> demandByDestination = ma.splitDemand(demand);
+        timer.restart();
+        ma.run(demandByDestination, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+        radius.assignmentTime = timer.elapsedMilliseconds();
+        radius.unassignedGroups = ma.getAssignmentData().unassignedGroups.size();
+    }
+};
+
+class FootpathRelaxationBenchmark : public ParameterizedCommand {
+
+private:
+    struct Network {
+        std::string fileName;
+        double averageDegree{0};
+        size_t destinations{0};
+        double relaxedDepartures{0};
+        double pushTime{0};
+        double pullTime{0};
+        size_t differentLabels{0};
+    };
+
+public:
+    FootpathRelaxationBenchmark(BasicShell& shell) :
+        ParameterizedCommand(shell, "footpathRelaxationBenchmark", "Compares the PAT computation with footpaths pushed to the profiles of nearby stops (footpathRelaxation = 0) and pulled from them on evaluation (footpathRelaxation = 1) for networks with different transfer graphs.", "CSA binaries:", "    Comma separated list, e.g., networks parsed with different maximum walking times") {
+        addParameter("CSA binaries");
+        addParameter("Settings file");
+        addParameter("Output file");
+        addParameter("Number of destinations", "100");
+        addParameter("Use transfer buffer times", "false");
+    }
+
+    virtual void execute() noexcept {
+        ConfigFile configFile(getParameter("Settings file"), true);
+        const Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+
+        std::vector<Network> networks;
+        for (const std::string& fileName : String::split(getParameter("CSA binaries"), ',')) {
+            networks.emplace_back(Network{fileName});
+            if (getParameter<bool>("Use transfer buffer times")) {
+                run<true>(networks.back(), settings);
+            } else {
+                run<false>(networks.back(), settings);
+            }
+        }
+
+        IO::OFStream file(getParameter("Output file"));
+        file << "network,averageDegree,destinations,relaxedDepartures,pushTime,pullTime,differentLabels\n";
+        std::cout << std::endl << std::right << std::setw(12) << "Degree" << std::setw(12) << "Relaxed" << std::setw(14) << "Push" << std::setw(14) << "Pull" << std::setw(12) << "Different" << "  Network" << std::endl;
+        for (const Network& network : networks) {
+            file << network.fileName << "," << network.averageDegree << "," << network.destinations << "," << network.relaxedDepartures << "," << network.pushTime << "," << network.pullTime << "," << network.differentLabels << "\n";
+            std::cout << std::setw(12) << String::prettyDouble(network.averageDegree) << std::setw(12) << String::percent(network.relaxedDepartures) << std::setw(14) << String::msToString(network.pushTime) << std::setw(14) << String::msToString(network.pullTime) << std::setw(12) << String::prettyInt(network.differentLabels) << "  " << network.fileName << std::endl;
+        }
+    }
+
+private:
+    template<bool USE_TRANSFER_BUFFER_TIMES>
+    inline void run(Network& network, const Assignment::Settings& settings) noexcept {
+        const size_t numberOfDestinations = getParameter<size_t>("Number of destinations");
+        const CSA::Data data = Assignment::AssignmentBundle::SortedData(network.fileName);
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(data);
+        const Assignment::PreparedNetwork preparedNetwork(data, reverseGraph);
+        network.averageDegree = preparedNetwork.stopReverseGraph.numEdges() / static_cast<double>(std::max<size_t>(data.numberOfStops(), 1));
+
+        Assignment::ComputePATs<Assignment::NoPATProfiler, USE_TRANSFER_BUFFER_TIMES> push(data, reverseGraph);
+        push.setStopReverseGraph(&preparedNetwork.stopReverseGraph);
+        Assignment::ComputePATs<Assignment::NoPATProfiler, USE_TRANSFER_BUFFER_TIMES> pull(data, reverseGraph);
+        pull.setPullFootpaths(true);
+
+        // Destinations are spread evenly over all vertices
+        const size_t numberOfVertices = data.transferGraph.numVertices();
+        network.destinations = std::min(numberOfDestinations, numberOfVertices);
+        Progress progress(network.destinations);
+        Timer timer;
+        for (size_t i = 0; i < network.destinations; i++) {
+            const Vertex destination = Vertex((i * numberOfVertices) / network.destinations);
+            timer.restart();
+            push.run(destination, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+            network.pushTime += timer.elapsedMilliseconds();
+            timer.restart();
+            pull.run(destination, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+            network.pullTime += timer.elapsedMilliseconds();
+            for (const ConnectionId j : data.connectionIds()) {
+                if (push.connectionLabel(j).transferPAT != pull.connectionLabel(j).transferPAT) network.differentLabels++;
+            }
+            // Pushing relaxes the footpaths only for departures that improve the profile of their stop, pulling relaxes
+            // them for every arrival
+            size_t profileEntries = 0;
+            for (const StopId stop : data.stops()) {
+                profileEntries += push.getProfile(stop).size() - 1;
+            }
+            network.relaxedDepartures += profileEntries / static_cast<double>(std::max<size_t>(data.numberOfConnections(), 1) * network.destinations);
+            progress++;
+        }
+        progress.finished();
+    }
+};
+
+class PATEngineBenchmark : public ParameterizedCommand {
+
+private:
+    struct Network {
+        std::string fileName;
+        size_t connections{0};
+        size_t transfers{0};
+        double precomputationTime{0};
+        size_t destinations{0};
+        double csaTime{0};
+        double tripBasedTime{0};
+        size_t differentLabels{0};
+        double csaAssignmentTime{0};
+        double tripBasedAssignmentTime{0};
+        size_t differentLoads{0};
+    };
+
+public:
+    PATEngineBenchmark(BasicShell& shell) :
+        ParameterizedCommand(shell, "patEngineBenchmark", "Compares the connection scan (ComputePATs) with the trip-based PAT computation (TripBasedPATs) on several networks. With a demand file, a complete assignment is computed with both engines as well.", "Demand file:", "    - to compare only the PAT computations") {
+        addParameter("CSA binaries");
+        addParameter("Settings file");
+        addParameter("Output file");
+        addParameter("Number of destinations", "100");
+        addParameter("Demand file", "-");
+        addParameter("Demand multiplier", "1");
+        addParameter("Num threads", "0");
+        addParameter("Use transfer buffer times", "false");
+    }
+
+    virtual void execute() noexcept {
+        ConfigFile configFile(getParameter("Settings file"), true);
+        const Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+
+        std::vector<Network> networks;
+        for (const std::string& fileName : String::split(getParameter("CSA binaries"), ',')) {
+            networks.emplace_back(Network{fileName});
+            if (getParameter<bool>("Use transfer buffer times")) {
+                run<true>(networks.back(), settings);
+            } else {
+                run<false>(networks.back(), settings);
+            }
+        }
+
+        IO::OFStream file(getParameter("Output file"));
+        file << "network,connections,transfers,precomputationTime,destinations,csaTime,tripBasedTime,differentLabels,csaAssignmentTime,tripBasedAssignmentTime,differentLoads\n";
+        std::cout << std::endl << std::right << std::setw(12) << "Connections" << std::setw(14) << "Transfers" << std::setw(14) << "Precompute" << std::setw(14) << "CSA" << std::setw(14) << "Trip-based" << std::setw(12) << "Different" << "  Network" << std::endl;
+        for (const Network& network : networks) {
+            file << network.fileName << "," << network.connections << "," << network.transfers << "," << network.precomputationTime << "," << network.destinations << "," << network.csaTime << "," << network.tripBasedTime << "," << network.differentLabels << "," << network.csaAssignmentTime << "," << network.tripBasedAssignmentTime << "," << network.differentLoads << "\n";
+            std::cout << std::setw(12) << String::prettyInt(network.connections) << std::setw(14) << String::prettyInt(network.transfers) << std::setw(14) << String::msToString(network.precomputationTime) << std::setw(14) << String::msToString(network.csaTime) << std::setw(14) << String::msToString(network.tripBasedTime) << std::setw(12) << String::prettyInt(network.differentLabels) << "  " << network.fileName << std::endl;
+            if (getParameter("Demand file") == "-") continue;
+            std::cout << std::setw(12) << "Assignment" << std::setw(42) << String::msToString(network.csaAssignmentTime) << std::setw(14) << String::msToString(network.tripBasedAssignmentTime) << std::setw(12) << String::prettyInt(network.differentLoads) << std::endl;
+        }
+    }
+
+private:
+    template<bool USE_TRANSFER_BUFFER_TIMES>
+    inline void run(Network& network, const Assignment::Settings& settings) noexcept {
+        using CSAEngine = Assignment::ComputePATs<Assignment::NoPATProfiler, USE_TRANSFER_BUFFER_TIMES>;
+        using TripBasedEngine = Assignment::TripBasedPATs<Assignment::NoPATProfiler, USE_TRANSFER_BUFFER_TIMES>;
+        const size_t numberOfDestinations = getParameter<size_t>("Number of destinations");
+        const CSA::Data data = Assignment::AssignmentBundle::SortedData(network.fileName);
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(data);
+        const Assignment::PreparedNetwork preparedNetwork(data, reverseGraph);
+        network.connections = data.numberOfConnections();
+
+        Timer timer;
+        const Assignment::TripTransfers transfers(data, settings.maxDelay, USE_TRANSFER_BUFFER_TIMES);
+        network.precomputationTime = timer.elapsedMilliseconds();
+        network.transfers = transfers.numberOfTransfers();
+
+        CSAEngine csa(data, reverseGraph);
+        csa.setStopReverseGraph(&preparedNetwork.stopReverseGraph);
+        TripBasedEngine tripBased(data, reverseGraph);
+        tripBased.setTransfers(&transfers);
+
+        // Destinations are spread evenly over all vertices
+        const size_t numberOfVertices = data.transferGraph.numVertices();
+        network.destinations = std::min(numberOfDestinations, numberOfVertices);
+        Progress progress(network.destinations);
+        for (size_t i = 0; i < network.destinations; i++) {
+            const Vertex destination = Vertex((i * numberOfVertices) / network.destinations);
+            timer.restart();
+            csa.run(destination, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+            network.csaTime += timer.elapsedMilliseconds();
+            timer.restart();
+            tripBased.run(destination, settings.maxDelay, settings.transferCosts, settings.walkingCosts, settings.waitingCosts);
+            network.tripBasedTime += timer.elapsedMilliseconds();
+            for (const ConnectionId j : data.connectionIds()) {
+                const typename CSAEngine::ConnectionLabel& a = csa.connectionLabel(j);
+                const typename TripBasedEngine::ConnectionLabel& b = tripBased.connectionLabel(j);
+                if ((a.tripPAT != b.tripPAT) || (a.transferPAT != b.transferPAT) || (a.skipPAT != b.skipPAT)) network.differentLabels++;
+            }
+            progress++;
+        }
+        progress.finished();
+
+        if (getParameter("Demand file") == "-") return;
+        const AccumulatedVertexDemand demand = Assignment::AssignmentBundle::DiscretizedDemand(AccumulatedVertexDemand::FromZoneCSV(getParameter("Demand file"), data, reverseGraph, getParameter<size_t>("Demand multiplier")), settings);
+        const std::vector<double> csaLoads = assign<Assignment::GroupAssignment<DecisionModels::Configurable, Assignment::NoProfiler, USE_TRANSFER_BUFFER_TIMES, CSAEngine>>(data, reverseGraph, preparedNetwork, demand, settings, network.csaAssignmentTime);
+        const std::vector<double> tripBasedLoads = assign<Assignment::GroupAssignment<DecisionModels::Configurable, Assignment::NoProfiler, USE_TRANSFER_BUFFER_TIMES, TripBasedEngine>>(data, reverseGraph, preparedNetwork, demand, settings, network.tripBasedAssignmentTime);
+        for (const ConnectionId j : data.connectionIds()) {
+            if (csaLoads[j] != tripBasedLoads[j]) network.differentLoads++;
+        }
+    }
+
+    // Returns the passenger count of every connection. The time includes the precomputation of the trip-based engine.
+    template<typename APPORTIONMENT_TYPE>
+    inline std::vector<double> assign(const CSA::Data& data, const CSA::TransferGraph& reverseGraph, const Assignment::PreparedNetwork& preparedNetwork, const AccumulatedVertexDemand& demand, const Assignment::Settings& settings, double& time) noexcept {
+        const int numThreads = getParameter<int>("Num threads");
+        APPORTIONMENT_TYPE ma(data, reverseGraph, settings);
+        ma.usePreparedNetwork(&preparedNetwork);
+        SplitDemand<AccumulatedVertexDemand::Entry> demandByDestination = ma.splitDemand(demand);
+        Timer timer;
+        ma.run(demandByDestination, std::max(numThreads, 1));
+        time = timer.elapsedMilliseconds();
+        return ma.getPassengerCountsPerConnection();
+    }
+};
+
+class DecisionModelBenchmark : public ParameterizedCommand {
+
+private:
+    struct Result {
+        std::string model;
+        double pairTime{0};
+        double vectorTime{0};
+        double directPairTime{-1};
+        double directVectorTime{-1};
+        size_t mismatches{0};
+    };
+
+public:
+    DecisionModelBenchmark(BasicShell& shell) :
+        ParameterizedCommand(shell, "decisionModelBenchmark", "Measures distribution(a, b) and distribution(values) of the decision models Linear, Logit, Kirchhoff and RelativeLogit for random PATs, and compares the tabulated values of the last three with evaluating std::exp or std::pow for every option.") {
+        addParameter("Settings file");
+        addParameter("Output file");
+        addParameter("Number of evaluations", "10000000");
+        addParameter("Max number of options", "8");
+        addParameter("Seed", "42");
+    }
+
+    virtual void execute() noexcept {
+        ConfigFile configFile(getParameter("Settings file"), true);
+        const Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+
+        // PATs differ from the minimum by up to twice the delay tolerance, such that options within and beyond the
+        // tolerance occur
+        const size_t numberOfInputs = 100000;
+        const size_t maxNumberOfOptions = std::max<size_t>(getParameter<size_t>("Max number of options"), 2);
+        std::mt19937 randomGenerator(getParameter<int>("Seed"));
+        std::uniform_int_distribution<size_t> numberOfOptions(2, maxNumberOfOptions);
+        std::uniform_int_distribution<int> basePAT(0, 24 * 60 * 60);
+        std::uniform_int_distribution<int> difference(0, 2 * std::max(settings.delayTolerance, 1) + 1);
+        std::vector<std::vector<int>> inputs(numberOfInputs);
+        for (std::vector<int>& values : inputs) {
+            const int base = basePAT(randomGenerator);
+            values.resize(numberOfOptions(randomGenerator));
+            for (int& value : values) {
+                value = base + difference(randomGenerator);
+            }
+        }
+
+        const DecisionModels::Logit logit(settings.delayTolerance, settings.beta, false);
+        const DecisionModels::Kirchhoff kirchhoff(settings.delayTolerance, settings.beta, false);
+        const DecisionModels::RelativeLogit relativeLogit(settings.delayTolerance, settings.beta, false);
+        std::vector<Result> results;
+        results.emplace_back(run("Linear", DecisionModels::Linear(settings), inputs));
+        results.emplace_back(run("Logit", DecisionModels::Logit(settings), inputs, &logit));
+        results.emplace_back(run("Kirchhoff", DecisionModels::Kirchhoff(settings), inputs, &kirchhoff));
+        results.emplace_back(run("RelativeLogit", DecisionModels::RelativeLogit(settings), inputs, &relativeLogit));
+
+        IO::OFStream file(getParameter("Output file"));
+        file << "model,pairTime,vectorTime,directPairTime,directVectorTime,mismatches\n";
+        std::cout << std::endl << std::right << std::setw(14) << "Model" << std::setw(14) << "Pair" << std::setw(14) << "Vector" << std::setw(14) << "Direct pair" << std::setw(14) << "Direct vector" << std::setw(12) << "Mismatches" << std::endl;
+        for (const Result& result : results) {
+            file << result.model << "," << result.pairTime << "," << result.vectorTime << "," << result.directPairTime << "," << result.directVectorTime << "," << result.mismatches << "\n";
+            std::cout << std::setw(14) << result.model << std::setw(14) << String::msToString(result.pairTime) << std::setw(14) << String::msToString(result.vectorTime);
+            if (result.directPairTime >= 0) {
+                std::cout << std::setw(14) << String::msToString(result.directPairTime) << std::setw(14) << String::msToString(result.directVectorTime) << std::setw(12) << String::prettyInt(result.mismatches);
+            }
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    // Without a reference model, only the times are measured
+    template<typename MODEL>
+    inline Result run(const std::string& model, const MODEL& tabulated, const std::vector<std::vector<int>>& inputs, const MODEL* reference = nullptr) noexcept {
+        Result result{model};
+        std::cout << "Measuring " << model << "..." << std::endl;
+        long long checksum = 0;
+        result.pairTime = measurePairs(tabulated, inputs, checksum);
+        result.vectorTime = measureVectors(tabulated, inputs, checksum);
+        if (!reference) return result;
+        long long referenceChecksum = 0;
+        result.directPairTime = measurePairs(*reference, inputs, referenceChecksum);
+        result.directVectorTime = measureVectors(*reference, inputs, referenceChecksum);
+        for (const std::vector<int>& values : inputs) {
+            if (tabulated.distribution(values[0], values[1]) != reference->distribution(values[0], values[1])) result.mismatches++;
+            if (tabulated.cumulativeDistribution(values[0], values[1]) != reference->cumulativeDistribution(values[0], values[1])) result.mismatches++;
+            if (tabulated.distribution(values) != reference->distribution(values)) result.mismatches++;
+            if (tabulated.cumulativeDistribution(values) != reference->cumulativeDistribution(values)) result.mismatches++;
+        }
+        Ensure(result.mismatches > 0 || checksum == referenceChecksum, "Checksums of " << model << " differ!");
+        return result;
+    }
+
+    template<typename MODEL>
+    inline double measurePairs(const MODEL& model, const std::vector<std::vector<int>>& inputs, long long& checksum) const noexcept {
+        const size_t numberOfEvaluations = getParameter<size_t>("Number of evaluations");
+        Timer timer;
+        for (size_t i = 0; i < numberOfEvaluations; i++) {
+            const std::vector<int>& values = inputs[i % inputs.size()];
+            checksum += model.distribution(values[0], values[1])[0];
+        }
+        return timer.elapsedMilliseconds();
+    }
+
+    template<typename MODEL>
+    inline double measureVectors(const MODEL& model, const std::vector<std::vector<int>>& inputs, long long& checksum) const noexcept {
+        const size_t numberOfEvaluations = getParameter<size_t>("Number of evaluations");
+        std::vector<int> result;
+        Timer timer;
+        for (size_t i = 0; i < numberOfEvaluations; i++) {
+            model.distribution(inputs[i % inputs.size()], result);
+            checksum += result.back();
+        }
+        return timer.elapsedMilliseconds();
+    }
+};
+
+class TimetableChangeImpact : public ParameterizedCommand {
+
+public:
+    TimetableChangeImpact(BasicShell& shell) :
+        ParameterizedCommand(shell, "timetableChangeImpact", "Compares two versions of a CSA network and determines the destinations whose assignment may be affected by the timetable changes. The stored results of all other destinations are migrated, such that a subsequent incremental groupAssignment on the new network recomputes only the affected destinations.", "Incremental result directory:", "    Same as for groupAssignment, use - to only report the affected destinations") {
+        addParameter("Settings file");
+        addParameter("Old CSA binary");
+        addParameter("New CSA binary");
+        addParameter("Demand file");
+        addParameter("Incremental result directory", "-");
+        addParameter("Demand multiplier", "1");
+        addParameter("Use transfer buffer times", "false");
+    }
+
+    virtual void execute() noexcept {
+        const std::string oldCsaFileName = getParameter("Old CSA binary");
+        const std::string newCsaFileName = getParameter("New CSA binary");
+        const std::string demandFileName = getParameter("Demand file");
+        const std::string resultDirectory = getParameter("Incremental result directory");
+        const size_t demandMultiplier = getParameter<size_t>("Demand multiplier");
+        const bool useTransferBufferTimes = getParameter<bool>("Use transfer buffer times");
+
+        ConfigFile configFile(getParameter("Settings file"), true);
+        Assignment::Settings settings(configFile);
+        configFile.writeIfModified(false);
+
+        const CSA::Data oldData = Assignment::AssignmentBundle::SortedData(oldCsaFileName);
+        const CSA::Data newData = Assignment::AssignmentBundle::SortedData(newCsaFileName);
+        const CSA::TransferGraph reverseGraph = Assignment::AssignmentBundle::ReverseGraph(newData);
+
+        Timer timer;
+        const Assignment::TimetableChangeImpact impact(oldData, newData, settings.periodicTimetable, settings.periodicHorizon);
+        std::cout << "Compared timetables in " << String::msToString(timer.elapsedMilliseconds()) << "." << std::endl;
+        if (!impact.hasSameTransferGraph()) {
+            std::cout << "   stops or transfer graph differ, all destinations are affected!" << std::endl;
+        } else {
+            std::cout << "   removed/changed trips: " << String::prettyInt(impact.getNumberOfChangedOldTrips()) << " (" << String::prettyInt(impact.getNumberOfChangedOldConnections()) << " connections)" << std::endl;
+            std::cout << "   added/changed trips: " << String::prettyInt(impact.getNumberOfChangedNewTrips()) << " (" << String::prettyInt(impact.getNumberOfChangedNewConnections()) << " connections)" << std::endl;
+        }
+
+        const AccumulatedVertexDemand demand = Assignment::AssignmentBundle::DiscretizedDemand(AccumulatedVertexDemand::FromZoneCSV(demandFileName, newData, reverseGraph, demandMultiplier), settings);
+        const Assignment::AssignmentBundle::DemandByDestination demandByDestination = Assignment::AssignmentBundle::Split(newData, reverseGraph, demand, settings);
+        size_t affectedDestinations = 0;
+        for (size_t i = 0; i < demandByDestination.size(); i++) {
+            if (impact.isAffected(demandByDestination.vertexAtIndex(i))) affectedDestinations++;
+        }
+        std::cout << "   affected destinations: " << String::prettyInt(affectedDestinations) << " of " << String::prettyInt(demandByDestination.size()) << std::endl;
+
+        if (resultDirectory == "-") return;
+        const Assignment::AssignmentStore oldStore(resultDirectory, oldCsaFileName, settings, useTransferBufferTimes);
+        const Assignment::AssignmentStore newStore(resultDirectory, newCsaFileName, settings, useTransferBufferTimes);
+        const size_t migratedDestinations = impact.migrate(demandByDestination, oldStore, newStore);
+        std::cout << "Migrated " << String::prettyInt(migratedDestinations) << " destinations, " << String::prettyInt(demandByDestination.size() - migratedDestinations) << " have to be recomputed." << std::endl;
+    }
+};
+
+class AssignmentServer : public ParameterizedCommand {
+
+private:
+    struct Network {
+        Network(const std::string& fileName) :
+            data(Assignment::AssignmentBundle::SortedData(fileName)),
+            reverseGraph(Assignment::AssignmentBundle::ReverseGraph(data)) {
+        }
+        CSA::Data data;
+        CSA::TransferGraph reverseGraph;
+    };
+
+    // A validated request, which is passed to the worker process as one tab separated line
+    struct Request {
+        size_t network;
+        std::string settingsFileName;
+        std::string demandFileName;
+        std::string outputFileName;
+        size_t demandMultiplier;
+    };
+
+    struct Job {
+        IO::UnixSocket client;
+        std::string request;
+    };
+
+    inline static const std::string WorkerReady = "worker ready";
+    inline static const std::string JobFinished = "job finished";
+    inline static constexpr int RequestTimeout = 10000;
+    inline static constexpr int AcceptRetryDelay = 100;
+
+public:
+    AssignmentServer(BasicShell& shell) :
+        ParameterizedCommand(shell, "assignmentServer", "Keeps networks loaded and computes assignment jobs that are submitted via a Unix domain socket (e.g. with submitAssignmentJob). Jobs are executed one after another by a worker process using all threads, progress is reported to the submitting client. If a job fails, the error is reported to its client and the worker is restarted.", "Request format (one line, tab separated):", "    <network> <settings file> <demand file> <output file> [<demand multiplier>], where <network> is the index or the file name of a loaded network", "    shutdown, to stop the server after all queued jobs are done", "Worker channel:", "    - (default), used internally to start the worker process") {
+        addParameter("Socket path");
+        addParameter("CSA binaries");
+        addParameter("Num threads", "0");
+        addParameter("Thread offset", "1");
+        addParameter("Use transfer buffer times", "false");
+        addParameter("Worker channel", "-");
+    }
+
+    virtual void execute() noexcept {
+        networkFileNames = String::split(getParameter("CSA binaries"), ',');
+        if (networkFileNames.empty()) {
+            shell.error("No networks specified!");
+            return;
+        }
+        if (getParameter("Worker channel") != "-") {
+            runWorker(IO::UnixSocket(getParameter<int>("Worker channel")));
+            return;
+        }
+
+        const std::string socketPath = getParameter("Socket path");
+        if (!startWorker()) {
+            shell.error("Cannot load the networks!");
+            return;
+        }
+        const IO::UnixSocket server = IO::UnixSocket::Listen(socketPath);
+        if (!server.isOpen()) {
+            const int error = errno;
+            stopWorker();
+            shell.error("Cannot listen on socket " + socketPath + " (" + std::strerror(error) + ")!");
+            return;
+        }
+        std::cout << "Listening on " << socketPath << std::endl;
+
+        stopping = false;
+        std::thread acceptor([&]() {
+            acceptJobs(server);
+        });
+        while (true) {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [&]() {return stopping || !jobs.empty();});
+            if (jobs.empty()) break;
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            runJob(job);
+        }
+        acceptor.join();
+        stopWorker();
+        unlink(socketPath.c_str());
+        std::cout << "Server stopped." << std::endl;
+    }
+
+private:
+    inline void acceptJobs(const IO::UnixSocket& server) noexcept {
+        while (true) {
+            IO::UnixSocket client = server.accept();
+            if (!client.isOpen()) {
+                const int error = errno;
+                if (error == EINTR || error == ECONNABORTED) continue;
+                if (error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM) {
+                    // Out of resources, retry after some connections have been closed
+                    std::this_thread::sleep_for(std::chrono::milliseconds(AcceptRetryDelay));
+                    continue;
+                }
+                std::cout << "Cannot accept connections (" << std::strerror(error) << "), stopping the server." << std::endl;
+                stop();
+                return;
+            }
+            // Idle clients must not block other submissions
+            client.setReceiveTimeout(RequestTimeout);
+            std::string request;
+            if (!client.readLine(request)) {
+                client.writeLine("error: no request received");
+                continue;
+            }
+            if (!request.empty() && request.back() == '\r') request.pop_back();
+            if (request == "shutdown") {
+                client.writeLine("shutting down");
+                stop();
+                return;
+            }
+            const std::vector<std::string> fields = String::split(request, '\t');
+            if (fields.size() < 4 || fields.size() > 5) {
+                client.writeLine("error: expected <network> <settings file> <demand file> <output file> [<demand multiplier>] separated by tabs");
+                continue;
+            }
+            const size_t network = findNetwork(fields[0]);
+            if (network >= networkFileNames.size()) {
+                client.writeLine("error: unknown network " + fields[0]);
+                continue;
+            }
+            const std::string settingsFileName = String::endsWith(fields[1], ".conf") ? fields[1] : fields[1] + ".conf";
+            if (!FileSystem::isFile(settingsFileName)) {
+                client.writeLine("error: settings file " + settingsFileName + " does not exist");
+                continue;
+            }
+            if (!FileSystem::isFile(fields[2])) {
+                client.writeLine("error: demand file " + fields[2] + " does not exist");
+                continue;
+            }
+            if (fields.size() == 5 && (fields[4].empty() || !std::all_of(fields[4].begin(), fields[4].end(), ::isdigit))) {
+                client.writeLine("error: invalid demand multiplier " + fields[4]);
+                continue;
+            }
+            const std::string demandMultiplier = (fields.size() == 5) ? fields[4] : "1";
+            std::lock_guard<std::mutex> lock(queueMutex);
+            client.writeLine("queued at position " + std::to_string(jobs.size() + 1));
+            jobs.emplace_back(Job{std::move(client), std::to_string(network) + "\t" + settingsFileName + "\t" + fields[2] + "\t" + fields[3] + "\t" + demandMultiplier});
+            queueChanged.notify_one();
+        }
+    }
+
+    inline void stop() noexcept {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        queueChanged.notify_one();
+    }
+
+    inline size_t findNetwork(const std::string& name) const noexcept {
+        for (size_t i = 0; i < networkFileNames.size(); i++) {
+            if (networkFileNames[i] == name) return i;
+        }
+        if (name.empty() || !std::all_of(name.begin(), name.end(), ::isdigit)) return -1;
+        return String::lexicalCast<size_t>(name);
+    }
+
+    // Passes the job to the worker and forwards its progress to the client. If the worker terminates during the job
+    // (e.g. because of invalid input), the job is reported as failed and the worker is restarted for the next job.
+    inline void runJob(Job& job) noexcept {
+        if (workerId <= 0 && !startWorker()) {
+            job.client.writeLine("error: the worker process cannot load the networks");
+            return;
+        }
+        worker.writeLine(job.request);
+        std::string line;
+        while (worker.readLine(line)) {
+            if (line == JobFinished) return;
+            job.client.writeLine(line);
+        }
+        const std::string reason = stopWorker();
+        std::cout << "Job failed, the worker " << reason << "." << std::endl;
+        job.client.writeLine("error: the job failed, the worker " + reason);
+    }
+
+    // The worker is started via exec instead of a plain fork, since the OpenMP runtime cannot be used in a forked child
+    // of a process that has used it before.
+    inline bool startWorker() noexcept {
+        std::pair<IO::UnixSocket, IO::UnixSocket> channel = IO::UnixSocket::Pair();
+        int input[2];
+        if (!channel.first.isOpen() || pipe2(input, O_CLOEXEC) != 0) return false;
+        const pid_t pid = fork();
+        if (pid == 0) {
+            dup2(input[0], STDIN_FILENO);
+            fcntl(channel.second.getFileDescriptor(), F_SETFD, 0);
+            execl("/proc/self/exe", "/proc/self/exe", static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(input[0]);
+        if (pid < 0) {
+            close(input[1]);
+            return false;
+        }
+        const std::string commands = "assignmentServer " + getParameter("Socket path") + " " + getParameter("CSA binaries") + " " + getParameter("Num threads") + " " + getParameter("Thread offset") + " " + getParameter("Use transfer buffer times") + " " + std::to_string(channel.second.getFileDescriptor()) + "\nq\n";
+        channel.second.close();
+        const bool written = write(input[1], commands.data(), commands.size()) == static_cast<ssize_t>(commands.size());
+        close(input[1]);
+        workerId = pid;
+        worker = std::move(channel.first);
+        std::string line;
+        if (written && worker.readLine(line) && line == WorkerReady) return true;
+        std::cout << "The worker " << stopWorker() << " while loading the networks." << std::endl;
+        return false;
+    }
+
+    // Returns a description of how the worker has terminated.
+    inline std::string stopWorker() noexcept {
+        if (workerId <= 0) return "was not running";
+        worker.close();
+        int status = 0;
+        waitpid(workerId, &status, 0);
+        workerId = -1;
+        if (WIFSIGNALED(status)) return "was terminated by signal " + std::to_string(WTERMSIG(status));
+        return "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+
+    inline void runWorker(IO::UnixSocket channel) noexcept {
+        networks.clear();
+        for (const std::string& fileName : networkFileNames) {
+            networks.emplace_back(std::make_unique<Network>(fileName));
+            networks.back()->data.printInfo();
+        }
+        channel.writeLine(WorkerReady);
+        std::string line;
+        while (channel.readLine(line)) {
+            const std::vector<std::string> fields = String::split(line, '\t');
+            AssertMsg(fields.size() == 5, "Invalid request " << line << "!");
+            const Request request{String::lexicalCast<size_t>(fields[0]), fields[1], fields[2], fields[3], String::lexicalCast<size_t>(fields[4])};
+            runRequest(channel, request);
+            channel.writeLine(JobFinished);
+        }
+    }
+
+    // The settings file is not modified, missing settings take their default values.
+    inline void runRequest(IO::UnixSocket& client, const Request& request) noexcept {
+        if (!FileSystem::isFile(request.settingsFileName)) {
+            client.writeLine("error: settings file " + request.settingsFileName + " does not exist");
+            return;
+        }
+        ConfigFile configFile(request.settingsFileName, true);
+        const Assignment::Settings settings(configFile);
+        if (settings.capacityIterations > 0) {
+            client.writeLine("error: capacity iterations are not supported by the server");
+            return;
+        }
+        chooseConfigurableAssignment(settings, getParameter<bool>("Use transfer buffer times"), [&](const auto type) {
+            computeApportionment<typename decltype(type)::Type>(client, request, settings);
+        });
+    }
+
+    template<typename APPORTIONMENT_TYPE>
+    inline void computeApportionment(IO::UnixSocket& client, const Request& request, const Assignment::Settings& settings) noexcept {
+        const int numThreads = getParameter<int>("Num threads");
+        const int pinMultiplier = getParameter<int>("Thread offset");
+        const Network& network = *networks[request.network];
+        Timer timer;
+        std::cout << "Job: " << request.demandFileName << " on " << networkFileNames[request.network] << " -> " << request.outputFileName << std::endl;
+
+        client.writeLine("loading demand");
+        const AccumulatedVertexDemand originalDemand = AccumulatedVertexDemand::FromZoneCSV(request.demandFileName, network.data, network.reverseGraph, request.demandMultiplier);
+        const AccumulatedVertexDemand demand = Assignment::AssignmentBundle::DiscretizedDemand(originalDemand, settings);
+
+        client.writeLine("assigning " + std::to_string(demand.entries.size()) + " demand entries");
+        APPORTIONMENT_TYPE ma(network.data, network.reverseGraph, settings);
+        ma.run(demand, std::max(numThreads, 1), (numThreads > 0) ? pinMultiplier : 1);
+        client.writeLine("assignment done after " + String::msToString(timer.elapsedMilliseconds()));
+
+        client.writeLine("writing output");
+        ma.printStatistics(originalDemand, request.outputFileName);
+        ma.writeConnectionsWithLoad(FileSystem::ensureExtension(request.outputFileName, "_connections.csv"));
+        ma.writeAssignment(FileSystem::ensureExtension(request.outputFileName, "_assignment.csv"));
+        ma.writeGroups(FileSystem::ensureExtension(request.outputFileName, "_groups.csv"));
+        ma.writeAssignedJourneys(FileSystem::ensureExtension(request.outputFileName, "_journeys.csv"), demand);
+        client.writeLine("done in " + String::msToString(timer.elapsedMilliseconds()));
+        std::cout << "Job done in " << String::msToString(timer.elapsedMilliseconds()) << "." << std::endl;
+    }
+
+private:
+    std::vector<std::string> networkFileNames;
+    std::vector<std::unique_ptr<Network>> networks;
+
+    IO::UnixSocket worker;
+    pid_t workerId{-1};
+
+    std::deque<Job> jobs;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    bool stopping;
+};
+
+class SubmitAssignmentJob : public ParameterizedCommand {
+
+public:
+    SubmitAssignmentJob(BasicShell& shell) :
+        ParameterizedCommand(shell, "submitAssignmentJob", "Submits an assignment job to a running assignmentServer and prints the reported progress until the job is done.", "Network:", "    Index or file name of a network loaded by the server, or shutdown to stop the server") {
+        addParameter("Socket path");
+        addParameter("Network");
+        addParameter("Settings file", "-");
+        addParameter("Demand file", "-");
+        addParameter("Output file", "-");
+        addParameter("Demand multiplier", "1");
+    }
+
+    virtual void execute() noexcept {
+        IO::UnixSocket server = IO::UnixSocket::Connect(getParameter("Socket path"));
+        if (!server.isOpen()) {
+            shell.error("Cannot connect to " + getParameter("Socket path") + "!");
+            return;
+        }
+        const std::string network = getParameter("Network");
+        if (network == "shutdown") {
+            server.writeLine(network);
+        } else {
+            server.writeLine(network + "\t" + getParameter("Settings file") + "\t" + getParameter("Demand file") + "\t" + getParameter("Output file") + "\t" + getParameter("Demand multiplier"));
+        }
+        std::string line;
+        while (server.readLine(line)) {
+            std::cout << line << std::endl;
+        }
+    }
+};